@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+    BATCH (COLUMNAR) ARITHMETIC IN C
+
+    From one pair to millions:
+    - perform_operations(a, b) in c_arrithmetic.c computes +, -, *, / and %
+      for a single pair and prints each result.
+    - Here the operands are two arrays (columns) and the results are five
+      arrays, one per operation. Row i of every result belongs to a[i], b[i].
+
+    SIMD kernels (compile with -mavx2):
+    - One AVX2 register holds 8 ints, so +, - and * run on 8 rows at once.
+    - There is no SIMD integer division instruction. Every int fits exactly
+      in a double, and a truncated double quotient of two ints is always the
+      exact integer quotient, so 4 divisions at a time are done in double.
+      The remainder is a - (a / b) * b.
+
+    No branches for division by zero:
+    - Rows with b == 0 are found with a compare, b is replaced by 1 in those
+      lanes so nothing traps, and their quotient and remainder are masked to
+      0 afterwards. A flag marks them.
+
+    Optional overflow flags (one byte per row):
+    - FLAG_ADD_OVERFLOW, FLAG_SUB_OVERFLOW, FLAG_MUL_OVERFLOW: the true
+      result does not fit in an int (the stored result wraps around).
+    - FLAG_DIV_OVERFLOW: INT_MIN / -1.
+    - FLAG_DIV_BY_ZERO: b == 0.
+    Pass flags == NULL to skip the overflow checks entirely.
+
+    The scalar function gives exactly the same results and flags, so it is
+    used on machines without AVX2, for the last few rows, and as a check.
+*/
+
+#define FLAG_ADD_OVERFLOW 1
+#define FLAG_SUB_OVERFLOW 2
+#define FLAG_MUL_OVERFLOW 4
+#define FLAG_DIV_OVERFLOW 8
+#define FLAG_DIV_BY_ZERO 16
+
+typedef struct {
+    int32_t *sum;
+    int32_t *difference;
+    int32_t *product;
+    int32_t *quotient;
+    int32_t *remainder;
+} BatchResults;
+
+// Function to compute all five operations for rows [start, n) one at a time
+void performOperationsScalar(const int32_t *a, const int32_t *b, size_t start, size_t n,
+                             BatchResults *out, uint8_t *flags) {
+    for (size_t i = start; i < n; i++) {
+        int32_t x = a[i], y = b[i];
+        uint8_t f = 0;
+        // Wrap-around results via unsigned arithmetic (signed overflow is undefined)
+        out->sum[i] = (int32_t)((uint32_t)x + (uint32_t)y);
+        out->difference[i] = (int32_t)((uint32_t)x - (uint32_t)y);
+        out->product[i] = (int32_t)((uint32_t)x * (uint32_t)y);
+        if (y == 0) {
+            out->quotient[i] = 0;
+            out->remainder[i] = 0;
+            f |= FLAG_DIV_BY_ZERO;
+        } else if (x == INT32_MIN && y == -1) {
+            out->quotient[i] = INT32_MIN;
+            out->remainder[i] = 0;
+            f |= FLAG_DIV_OVERFLOW;
+        } else {
+            out->quotient[i] = x / y;
+            out->remainder[i] = x % y;
+        }
+        if (flags != NULL) {
+            int64_t wide;
+            wide = (int64_t)x + y;
+            if (wide != (int32_t)wide) f |= FLAG_ADD_OVERFLOW;
+            wide = (int64_t)x - y;
+            if (wide != (int32_t)wide) f |= FLAG_SUB_OVERFLOW;
+            wide = (int64_t)x * y;
+            if (wide != (int32_t)wide) f |= FLAG_MUL_OVERFLOW;
+            flags[i] = f;
+        }
+    }
+}
+
+#ifdef __AVX2__
+// Function to check 8 products for overflow; returns all-ones lanes where one happened
+static inline __m256i mulOverflow(__m256i x, __m256i y) {
+    // _mm256_mul_epi32 multiplies the even lanes into 64-bit products
+    __m256i even = _mm256_mul_epi32(x, y);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+    // A product fits if its high half equals the sign of its low half
+    __m256i evenOk = _mm256_cmpeq_epi32(even, _mm256_slli_epi64(_mm256_srai_epi32(even, 31), 32));
+    __m256i oddOk = _mm256_cmpeq_epi32(odd, _mm256_slli_epi64(_mm256_srai_epi32(odd, 31), 32));
+    // The answers sit in the odd 32-bit positions: move the even ones down
+    __m256i ok = _mm256_blend_epi32(_mm256_srli_epi64(evenOk, 32), oddOk, 0xAA);
+    return _mm256_xor_si256(ok, _mm256_set1_epi32(-1));
+}
+
+// Function to truncate-divide 4 ints (as doubles) at a time
+static inline __m128i divide4(__m128i x, __m128i y) {
+    return _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(x), _mm256_cvtepi32_pd(y)));
+}
+#endif
+
+// Function to compute all five operations on whole columns
+void performOperationsBatch(const int32_t *a, const int32_t *b, size_t n, BatchResults *out,
+                            uint8_t *flags) {
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i sum = _mm256_add_epi32(x, y);
+        __m256i difference = _mm256_sub_epi32(x, y);
+        _mm256_storeu_si256((__m256i *)(out->sum + i), sum);
+        _mm256_storeu_si256((__m256i *)(out->difference + i), difference);
+        _mm256_storeu_si256((__m256i *)(out->product + i), _mm256_mullo_epi32(x, y));
+
+        // Division: lanes with y == 0 divide by 1 and are zeroed afterwards
+        __m256i isZero = _mm256_cmpeq_epi32(y, zero);
+        __m256i safeY = _mm256_blendv_epi8(y, one, isZero);
+        __m128i qLow = divide4(_mm256_castsi256_si128(x), _mm256_castsi256_si128(safeY));
+        __m128i qHigh = divide4(_mm256_extracti128_si256(x, 1), _mm256_extracti128_si256(safeY, 1));
+        __m256i q = _mm256_set_m128i(qHigh, qLow);
+        __m256i r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, safeY));
+        _mm256_storeu_si256((__m256i *)(out->quotient + i), _mm256_andnot_si256(isZero, q));
+        _mm256_storeu_si256((__m256i *)(out->remainder + i), _mm256_andnot_si256(isZero, r));
+
+        if (flags != NULL) {
+            // Sign-bit tests: (x ^ s) & (y ^ s) < 0 means x + y overflowed
+            __m256i addOver = _mm256_srai_epi32(
+                _mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum)), 31);
+            __m256i subOver = _mm256_srai_epi32(
+                _mm256_and_si256(_mm256_xor_si256(x, y), _mm256_xor_si256(x, difference)), 31);
+            __m256i divOver = _mm256_and_si256(_mm256_cmpeq_epi32(x, _mm256_set1_epi32(INT32_MIN)),
+                                               _mm256_cmpeq_epi32(y, _mm256_set1_epi32(-1)));
+            __m256i f = _mm256_and_si256(addOver, _mm256_set1_epi32(FLAG_ADD_OVERFLOW));
+            f = _mm256_or_si256(f, _mm256_and_si256(subOver, _mm256_set1_epi32(FLAG_SUB_OVERFLOW)));
+            f = _mm256_or_si256(f, _mm256_and_si256(mulOverflow(x, y), _mm256_set1_epi32(FLAG_MUL_OVERFLOW)));
+            f = _mm256_or_si256(f, _mm256_and_si256(divOver, _mm256_set1_epi32(FLAG_DIV_OVERFLOW)));
+            f = _mm256_or_si256(f, _mm256_and_si256(isZero, _mm256_set1_epi32(FLAG_DIV_BY_ZERO)));
+            // Narrow 8 x int32 to 8 bytes: pack within each 128-bit half, then join the halves
+            __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(f, f), zero);
+            bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+            _mm_storel_epi64((__m128i *)(flags + i), _mm256_castsi256_si128(bytes));
+        }
+    }
+#endif
+    performOperationsScalar(a, b, i, n, out, flags);
+}
+
+// The original single-pair version, kept for the small demo below
+void perform_operations(int a, int b) {
+    printf("Addition: %d + %d = %d\n", a, b, a + b);
+    printf("Subtraction: %d - %d = %d\n", a, b, a - b);
+    printf("Multiplication: %d * %d = %d\n", a, b, a * b);
+    if (b != 0) {
+        printf("Division: %d / %d = %d\n", a, b, a / b);
+        printf("Modulus: %d %% %d = %d\n", a, b, a % b);
+    } else {
+        printf("Division and modulus by zero are not allowed.\n");
+    }
+}
+
+// Function to allocate result columns; memset touches every page up front,
+// so page faults do not end up in the timings
+int allocResults(BatchResults *r, size_t n) {
+    int32_t **columns[] = {&r->sum, &r->difference, &r->product, &r->quotient, &r->remainder};
+    for (int c = 0; c < 5; c++) {
+        *columns[c] = malloc(n * sizeof(int32_t));
+        if (*columns[c] == NULL) return -1;
+        memset(*columns[c], 0, n * sizeof(int32_t));
+    }
+    return 0;
+}
+
+void freeResults(BatchResults *r) {
+    free(r->sum);
+    free(r->difference);
+    free(r->product);
+    free(r->quotient);
+    free(r->remainder);
+}
+
+int sameResults(BatchResults *x, BatchResults *y, size_t n) {
+    size_t bytes = n * sizeof(int32_t);
+    return memcmp(x->sum, y->sum, bytes) == 0 && memcmp(x->difference, y->difference, bytes) == 0 &&
+           memcmp(x->product, y->product, bytes) == 0 && memcmp(x->quotient, y->quotient, bytes) == 0 &&
+           memcmp(x->remainder, y->remainder, bytes) == 0;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    // A small batch, including the edge cases
+    int32_t a[] = {17, 100, -7, INT32_MAX, INT32_MIN, 65536, 9, 42, 5};
+    int32_t b[] = {5, 0, 2, 1, -1, 65536, -4, 42, 0};
+    size_t count = sizeof(a) / sizeof(a[0]);
+    int32_t columns[5][16];
+    uint8_t flags[16];
+    BatchResults small = {columns[0], columns[1], columns[2], columns[3], columns[4]};
+    performOperationsBatch(a, b, count, &small, flags);
+
+    printf("%11s %11s | %11s %11s %11s %11s %5s | flags\n", "a", "b", "a+b", "a-b", "a*b", "a/b", "a%b");
+    for (size_t i = 0; i < count; i++) {
+        printf("%11d %11d | %11d %11d %11d %11d %5d | %s%s%s%s%s\n", a[i], b[i], small.sum[i],
+               small.difference[i], small.product[i], small.quotient[i], small.remainder[i],
+               flags[i] & FLAG_ADD_OVERFLOW ? "add-overflow " : "",
+               flags[i] & FLAG_SUB_OVERFLOW ? "sub-overflow " : "",
+               flags[i] & FLAG_MUL_OVERFLOW ? "mul-overflow " : "",
+               flags[i] & FLAG_DIV_OVERFLOW ? "div-overflow " : "",
+               flags[i] & FLAG_DIV_BY_ZERO ? "div-by-zero" : "");
+    }
+    printf("\nThe original function for the first row:\n");
+    perform_operations(a[0], b[0]);
+
+    // Benchmark over many random rows
+    size_t n = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+    int32_t *x = malloc(n * sizeof(int32_t)), *y = malloc(n * sizeof(int32_t));
+    uint8_t *f1 = malloc(n), *f2 = malloc(n);
+    BatchResults scalar, batch;
+    if (x == NULL || y == NULL || f1 == NULL || f2 == NULL || allocResults(&scalar, n) || allocResults(&batch, n)) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    memset(f1, 0, n);
+    memset(f2, 0, n);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < n; i++) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        x[i] = (int32_t)state;
+        y[i] = i % 100 == 0 ? 0 : (int32_t)(state >> 32) >> (state % 31);   // Mixed sizes, some zeros
+    }
+
+    // Warm-up passes, so the first timing does not pay for cold caches and TLBs
+    performOperationsScalar(x, y, 0, n, &scalar, f1);
+    performOperationsBatch(x, y, n, &batch, f2);
+
+    double start = nowSeconds();
+    performOperationsScalar(x, y, 0, n, &scalar, f1);
+    double scalarTime = nowSeconds() - start;
+    start = nowSeconds();
+    performOperationsBatch(x, y, n, &batch, f2);
+    double batchTime = nowSeconds() - start;
+    start = nowSeconds();
+    performOperationsBatch(x, y, n, &batch, NULL);
+    double noFlagsTime = nowSeconds() - start;
+
+    printf("\n%zu rows, all five operations:\n", n);
+    printf("  scalar:               %.2f ns/row\n", scalarTime * 1e9 / n);
+#ifdef __AVX2__
+    printf("  AVX2 batch + flags:   %.2f ns/row\n", batchTime * 1e9 / n);
+    printf("  AVX2 batch, no flags: %.2f ns/row\n", noFlagsTime * 1e9 / n);
+#else
+    printf("  batch (no AVX2, scalar fallback): %.2f ns/row, no flags: %.2f ns/row\n",
+           batchTime * 1e9 / n, noFlagsTime * 1e9 / n);
+#endif
+    printf("  Results match: %s\n", sameResults(&scalar, &batch, n) && memcmp(f1, f2, n) == 0 ? "yes" : "no");
+
+    free(x); free(y); free(f1); free(f2);
+    freeResults(&scalar);
+    freeResults(&batch);
+    return 0;
+}
@@ -0,0 +1,608 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/*
+    ARBITRARY-PRECISION INTEGERS IN C
+
+    Why:
+    - factorial(int n) in c_functions_and_structure_notes.c overflows at
+      13! because an int holds at most about 2.1 billion. 100000! has
+      456574 decimal digits.
+
+    Representation:
+    - A BigInt is an array of 64-bit "limbs", least significant first:
+      value = d[0] + d[1] * 2^64 + d[2] * 2^128 + ...
+    - unsigned __int128 (a GCC/Clang extension) holds the full 128-bit
+      product of two limbs, so carries are easy to get right.
+    - Only non-negative numbers are needed here.
+
+    Multiplication:
+    - Schoolbook: every limb of a times every limb of b, O(n^2).
+    - Karatsuba: split a = a1*B^h + a0 and b = b1*B^h + b0, then
+        a*b = z2*B^2h + z1*B^h + z0, with z0 = a0*b0, z2 = a1*b1 and
+        z1 = (a0 + a1)(b0 + b1) - z0 - z2.
+      Three half-size products instead of four gives O(n^1.585).
+
+    Factorial and binomials:
+    - Multiplying 1*2*3*...*n left to right multiplies a huge number by a
+      tiny one n times. Binary splitting multiplies the two halves of the
+      range recursively, so the big multiplications are between numbers
+      of similar size, where Karatsuba helps. Factors of two are removed
+      first and added back as one shift at the end.
+    - C(n, k) is built from its prime factorization (Legendre's formula),
+      so no big division is needed.
+
+    Base-10 conversion:
+    - Dividing by 10^19 again and again is O(n^2) hardware divisions.
+    - Divide and conquer instead: split x by 10^(19*2^k) into a high and a
+      low half, and convert each half recursively. The big divisions use
+      Barrett reduction with a reciprocal found by Newton's method, so
+      they cost a few multiplications each.
+*/
+
+#define KARATSUBA_THRESHOLD 32
+#define TEN_POW_19 10000000000000000000ULL
+#define LEAF_LEVEL 4   // Levels 0..4 (up to 608 digits) use plain division
+
+typedef unsigned __int128 u128;
+
+typedef struct {
+    uint64_t *d;
+    size_t n;     // Limbs in use (no leading zero limbs; 0 means the value 0)
+    size_t cap;
+} BigInt;
+
+/*
+    Raw limb-array helpers.
+*/
+static size_t normLength(const uint64_t *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) n--;
+    return n;
+}
+
+// r[0..rn) += x[0..xn)
+static void addInto(uint64_t *r, size_t rn, const uint64_t *x, size_t xn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < xn; i++) {
+        u128 t = (u128)r[i] + x[i] + carry;
+        r[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    for (; carry != 0 && i < rn; i++) {
+        r[i] += 1;
+        carry = r[i] == 0;
+    }
+}
+
+// r[0..rn) -= x[0..xn), the result must not be negative
+static void subInto(uint64_t *r, size_t rn, const uint64_t *x, size_t xn) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < xn; i++) {
+        uint64_t xi = x[i];
+        uint64_t t = r[i] - xi - borrow;
+        borrow = (r[i] < xi) || (r[i] - xi < borrow);
+        r[i] = t;
+    }
+    for (; borrow != 0 && i < rn; i++) {
+        borrow = r[i] == 0;
+        r[i] -= 1;
+    }
+}
+
+// r[0..na+nb) += a * b (r must start out zero in that range)
+static void mulSchool(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *r) {
+    for (size_t i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; j++) {
+            u128 t = (u128)a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[i + nb] = carry;
+    }
+}
+
+static void *allocLimbs(size_t n) {
+    void *p = calloc(n > 0 ? n : 1, sizeof(uint64_t));
+    if (p == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    return p;
+}
+
+// r[0..na+nb) = a * b, choosing schoolbook or Karatsuba
+static void mulRaw(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *r) {
+    size_t rn = na + nb;
+    memset(r, 0, rn * sizeof(uint64_t));
+    na = normLength(a, na);
+    nb = normLength(b, nb);
+    if (na == 0 || nb == 0) return;
+    if (na < nb) {
+        const uint64_t *ts = a; a = b; b = ts;
+        size_t tn = na; na = nb; nb = tn;
+    }
+    if (nb < KARATSUBA_THRESHOLD) {
+        mulSchool(a, na, b, nb, r);
+        return;
+    }
+    if (na >= 2 * nb) {
+        // Very different sizes: multiply b by nb-limb slices of a
+        uint64_t *t = allocLimbs(2 * nb);
+        for (size_t off = 0; off < na; off += nb) {
+            size_t len = na - off < nb ? na - off : nb;
+            mulRaw(a + off, len, b, nb, t);
+            addInto(r + off, rn - off, t, len + nb);
+        }
+        free(t);
+        return;
+    }
+
+    size_t h = na / 2;   // nb > na / 2 >= h, so both halves of b are non-empty
+    size_t na1 = na - h, nb1 = nb - h;
+    uint64_t *z0 = allocLimbs(2 * h);
+    uint64_t *z2 = allocLimbs(na1 + nb1);
+    mulRaw(a, h, b, h, z0);
+    mulRaw(a + h, na1, b + h, nb1, z2);
+
+    // sa = a0 + a1, sb = b0 + b1 (each may be one limb longer)
+    size_t la = (na1 > h ? na1 : h) + 1, lb = (nb1 > h ? nb1 : h) + 1;
+    uint64_t *sa = allocLimbs(la), *sb = allocLimbs(lb);
+    memcpy(sa, a + h, na1 * sizeof(uint64_t));
+    addInto(sa, la, a, h);
+    memcpy(sb, b, h * sizeof(uint64_t));
+    addInto(sb, lb, b + h, nb1);
+
+    uint64_t *z1 = allocLimbs(la + lb);
+    mulRaw(sa, la, sb, lb, z1);
+    subInto(z1, la + lb, z0, 2 * h);
+    subInto(z1, la + lb, z2, na1 + nb1);
+
+    addInto(r, rn, z0, 2 * h);
+    addInto(r + h, rn - h, z1, normLength(z1, la + lb));
+    addInto(r + 2 * h, rn - 2 * h, z2, na1 + nb1);
+    free(z0); free(z1); free(z2); free(sa); free(sb);
+}
+
+/*
+    BigInt functions.
+*/
+BigInt bigNew(size_t cap) {
+    BigInt x = {allocLimbs(cap), 0, cap > 0 ? cap : 1};
+    return x;
+}
+
+BigInt bigFromU64(uint64_t v) {
+    BigInt x = bigNew(1);
+    x.d[0] = v;
+    x.n = v != 0;
+    return x;
+}
+
+// Function to copy limbs [from, n) of x, which divides by 2^(64*from)
+BigInt bigCopyFrom(const BigInt *x, size_t from) {
+    size_t n = x->n > from ? x->n - from : 0;
+    BigInt r = bigNew(n);
+    memcpy(r.d, x->d + from, n * sizeof(uint64_t));
+    r.n = n;
+    return r;
+}
+
+void bigFree(BigInt *x) {
+    free(x->d);
+    x->d = NULL;
+    x->n = x->cap = 0;
+}
+
+void bigReserve(BigInt *x, size_t cap) {
+    if (cap <= x->cap) return;
+    x->d = realloc(x->d, cap * sizeof(uint64_t));
+    if (x->d == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    memset(x->d + x->cap, 0, (cap - x->cap) * sizeof(uint64_t));
+    x->cap = cap;
+}
+
+int bigCompare(const BigInt *a, const BigInt *b) {
+    if (a->n != b->n) return a->n < b->n ? -1 : 1;
+    for (size_t i = a->n; i-- > 0;) {
+        if (a->d[i] != b->d[i]) return a->d[i] < b->d[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigInt bigMul(const BigInt *a, const BigInt *b) {
+    BigInt r = bigNew(a->n + b->n);
+    mulRaw(a->d, a->n, b->d, b->n, r.d);
+    r.n = normLength(r.d, a->n + b->n);
+    return r;
+}
+
+// a = a - b in place (requires a >= b)
+void bigSubInPlace(BigInt *a, const BigInt *b) {
+    subInto(a->d, a->n, b->d, b->n);
+    a->n = normLength(a->d, a->n);
+}
+
+// a = a + b in place
+void bigAddInPlace(BigInt *a, const BigInt *b) {
+    size_t n = (a->n > b->n ? a->n : b->n) + 1;
+    bigReserve(a, n);
+    addInto(a->d, n, b->d, b->n);
+    a->n = normLength(a->d, n);
+}
+
+void bigAddU64(BigInt *a, uint64_t v) {
+    BigInt t = {&v, v != 0, 1};
+    bigAddInPlace(a, &t);
+}
+
+void bigMulU64(BigInt *a, uint64_t v) {
+    bigReserve(a, a->n + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->n; i++) {
+        u128 t = (u128)a->d[i] * v + carry;
+        a->d[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    a->d[a->n] = carry;
+    a->n = normLength(a->d, a->n + 1);
+}
+
+// Function to divide in place by a single limb; returns the remainder
+uint64_t bigDivU64(BigInt *a, uint64_t v) {
+    u128 rem = 0;
+    for (size_t i = a->n; i-- > 0;) {
+        u128 cur = (rem << 64) | a->d[i];
+        a->d[i] = (uint64_t)(cur / v);
+        rem = cur % v;
+    }
+    a->n = normLength(a->d, a->n);
+    return (uint64_t)rem;
+}
+
+// Function to return x * 2^bits
+BigInt bigShiftLeft(const BigInt *x, size_t bits) {
+    size_t limbs = bits / 64, s = bits % 64;
+    BigInt r = bigNew(x->n + limbs + 1);
+    for (size_t i = 0; i < x->n; i++) {
+        r.d[i + limbs] |= x->d[i] << s;
+        if (s != 0) r.d[i + limbs + 1] = x->d[i] >> (64 - s);
+    }
+    r.n = normLength(r.d, x->n + limbs + 1);
+    return r;
+}
+
+// Function to divide by 2^s in place (s < 64)
+void bigShiftRightBits(BigInt *x, unsigned s) {
+    if (s == 0) return;
+    for (size_t i = 0; i < x->n; i++) {
+        x->d[i] = (x->d[i] >> s) | (i + 1 < x->n ? x->d[i + 1] << (64 - s) : 0);
+    }
+    x->n = normLength(x->d, x->n);
+}
+
+// Function to build B^k = 2^(64k)
+BigInt bigPowB(size_t k) {
+    BigInt r = bigNew(k + 1);
+    r.d[k] = 1;
+    r.n = k + 1;
+    return r;
+}
+
+/*
+    Reciprocal by Newton's method.
+    p: m limbs with the top bit set. Returns floor(B^(2m) / p).
+*/
+BigInt reciprocal(const uint64_t *p, size_t m) {
+    BigInt P = {(uint64_t *)p, m, m};   // Borrowed view, never freed
+    BigInt target = bigPowB(2 * m);
+    BigInt x;
+    if (m == 1) {
+        x = bigPowB(2);
+        bigDivU64(&x, p[0]);
+    } else {
+        // Reciprocal of the top half, scaled up, is a good first guess
+        size_t h = (m + 1) / 2;
+        BigInt top = reciprocal(p + (m - h), h);
+        BigInt shifted = bigShiftLeft(&top, 64 * (m - h));
+        bigFree(&top);
+        x = shifted;
+
+        // One Newton step: x += x * (B^2m - p*x) / B^2m
+        BigInt px = bigMul(&P, &x);
+        int below = bigCompare(&px, &target) <= 0;
+        BigInt e;
+        if (below) {
+            e = bigCopyFrom(&target, 0);
+            bigSubInPlace(&e, &px);
+        } else {
+            e = bigCopyFrom(&px, 0);
+            bigSubInPlace(&e, &target);
+        }
+        BigInt xe = bigMul(&x, &e);
+        BigInt correction = bigCopyFrom(&xe, 2 * m);
+        if (below) bigAddInPlace(&x, &correction);
+        else bigSubInPlace(&x, &correction);
+        bigFree(&px); bigFree(&e); bigFree(&xe); bigFree(&correction);
+    }
+
+    // Make the result exact: afterwards 0 <= B^2m - p*x < p
+    BigInt px = bigMul(&P, &x);
+    BigInt one = bigFromU64(1);
+    while (bigCompare(&px, &target) > 0) {
+        bigSubInPlace(&x, &one);
+        bigSubInPlace(&px, &P);
+    }
+    BigInt rest = bigCopyFrom(&target, 0);
+    bigSubInPlace(&rest, &px);
+    while (bigCompare(&rest, &P) >= 0) {
+        bigAddU64(&x, 1);
+        bigSubInPlace(&rest, &P);
+    }
+    bigFree(&px); bigFree(&one); bigFree(&rest); bigFree(&target);
+    return x;
+}
+
+/*
+    Decimal conversion by divide and conquer.
+    Level k divides by P_k = 10^(19 * 2^k). P_k is stored shifted left by
+    'shift' bits so its top bit is set, which Barrett reduction needs.
+*/
+typedef struct {
+    BigInt power;     // P_k (unshifted)
+    BigInt divisor;   // P_k << shift
+    unsigned shift;
+    BigInt inverse;   // floor(B^(2m) / divisor), m = divisor.n
+} PowerLevel;
+
+// Function to split x (< P_k^2) into x / P_k and x % P_k with Barrett reduction
+void barrettDivide(const BigInt *x, PowerLevel *level, BigInt *q, BigInt *r) {
+    size_t m = level->divisor.n;
+    BigInt xs = bigShiftLeft(x, level->shift);
+    BigInt top = bigCopyFrom(&xs, m - 1);
+    BigInt t = bigMul(&top, &level->inverse);
+    *q = bigCopyFrom(&t, m + 1);
+    BigInt qd = bigMul(q, &level->divisor);
+    bigSubInPlace(&xs, &qd);   // The estimate is never too big
+    while (bigCompare(&xs, &level->divisor) >= 0) {   // ...and at most 2 too small
+        bigSubInPlace(&xs, &level->divisor);
+        bigAddU64(q, 1);
+    }
+    bigShiftRightBits(&xs, level->shift);
+    *r = xs;
+    bigFree(&top); bigFree(&t); bigFree(&qd);
+}
+
+// Function to write exactly 19 * 2^(k+1) digits of x (x < P_k^2) to out
+void decimalRecursive(const BigInt *x, int k, PowerLevel *levels, char *out) {
+    if (k <= LEAF_LEVEL) {
+        BigInt t = bigCopyFrom(x, 0);
+        for (long chunk = (1L << (k + 1)) - 1; chunk >= 0; chunk--) {
+            uint64_t digits = bigDivU64(&t, TEN_POW_19);
+            for (int i = 18; i >= 0; i--) {
+                out[chunk * 19 + i] = (char)('0' + digits % 10);
+                digits /= 10;
+            }
+        }
+        bigFree(&t);
+        return;
+    }
+    BigInt q, r;
+    barrettDivide(x, &levels[k], &q, &r);
+    decimalRecursive(&q, k - 1, levels, out);
+    decimalRecursive(&r, k - 1, levels, out + 19 * (1L << k));
+    bigFree(&q);
+    bigFree(&r);
+}
+
+// Function to convert x to a decimal string (caller frees)
+char *bigToDecimal(const BigInt *x) {
+    if (x->n == 0) {
+        char *zero = malloc(2);
+        strcpy(zero, "0");
+        return zero;
+    }
+    size_t bits = 64 * x->n - __builtin_clzll(x->d[x->n - 1]);
+    size_t maxDigits = (size_t)(bits * 0.30103) + 1;
+    int top = LEAF_LEVEL;
+    while (19 * (1UL << (top + 1)) < maxDigits) top++;
+
+    PowerLevel *levels = calloc(top + 1, sizeof(PowerLevel));
+    levels[0].power = bigFromU64(TEN_POW_19);
+    for (int k = 1; k <= top; k++) {
+        levels[k].power = bigMul(&levels[k - 1].power, &levels[k - 1].power);
+    }
+    for (int k = LEAF_LEVEL + 1; k <= top; k++) {
+        PowerLevel *level = &levels[k];
+        level->shift = __builtin_clzll(level->power.d[level->power.n - 1]);
+        level->divisor = bigShiftLeft(&level->power, level->shift);
+        level->inverse = reciprocal(level->divisor.d, level->divisor.n);
+    }
+
+    size_t width = 19 * (1UL << (top + 1));
+    char *buffer = malloc(width + 1);
+    decimalRecursive(x, top, levels, buffer);
+    buffer[width] = '\0';
+    size_t skip = 0;
+    while (skip + 1 < width && buffer[skip] == '0') skip++;
+    memmove(buffer, buffer + skip, width - skip + 1);
+
+    for (int k = 0; k <= top; k++) {
+        bigFree(&levels[k].power);
+        if (k > LEAF_LEVEL) {
+            bigFree(&levels[k].divisor);
+            bigFree(&levels[k].inverse);
+        }
+    }
+    free(levels);
+    return buffer;
+}
+
+// Function for the simple O(n^2) conversion (repeated division by 10^19)
+char *bigToDecimalSimple(const BigInt *x) {
+    size_t chunks = x->n * 20 / 19 + 2;
+    char *buffer = malloc(chunks * 19 + 1);
+    BigInt t = bigCopyFrom(x, 0);
+    size_t pos = chunks * 19;
+    buffer[pos] = '\0';
+    do {
+        uint64_t digits = bigDivU64(&t, TEN_POW_19);
+        for (int i = 0; i < 19; i++) {
+            buffer[--pos] = (char)('0' + digits % 10);
+            digits /= 10;
+        }
+    } while (t.n > 0);
+    while (buffer[pos] == '0' && buffer[pos + 1] != '\0') pos++;
+    memmove(buffer, buffer + pos, chunks * 19 - pos + 1);
+    bigFree(&t);
+    return buffer;
+}
+
+/*
+    Products by binary splitting.
+*/
+
+// Function to multiply factors[lo..hi) together
+BigInt productOfList(const uint64_t *factors, size_t lo, size_t hi) {
+    if (hi - lo <= 16) {
+        BigInt r = bigFromU64(1);
+        uint64_t packed = 1;
+        for (size_t i = lo; i < hi; i++) {
+            if (packed > UINT64_MAX / factors[i]) {   // Would overflow: flush
+                bigMulU64(&r, packed);
+                packed = 1;
+            }
+            packed *= factors[i];
+        }
+        bigMulU64(&r, packed);
+        return r;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    BigInt left = productOfList(factors, lo, mid);
+    BigInt right = productOfList(factors, mid, hi);
+    BigInt r = bigMul(&left, &right);
+    bigFree(&left);
+    bigFree(&right);
+    return r;
+}
+
+// Function to compute n! exactly
+BigInt bigFactorial(uint64_t n) {
+    uint64_t *odd = allocLimbs(n + 1);
+    size_t count = 0, twos = 0;
+    for (uint64_t i = 2; i <= n; i++) {
+        uint64_t v = i;
+        int z = __builtin_ctzll(v);
+        twos += z;
+        v >>= z;
+        if (v > 1) odd[count++] = v;
+    }
+    BigInt product = productOfList(odd, 0, count);
+    BigInt r = bigShiftLeft(&product, twos);
+    bigFree(&product);
+    free(odd);
+    return r;
+}
+
+// Function giving the exponent of prime p in n! (Legendre's formula)
+uint64_t legendre(uint64_t n, uint64_t p) {
+    uint64_t e = 0;
+    while (n > 0) {
+        n /= p;
+        e += n;
+    }
+    return e;
+}
+
+// Function to compute the binomial coefficient C(n, k) exactly
+BigInt bigBinomial(uint64_t n, uint64_t k) {
+    if (k > n) return bigFromU64(0);
+    char *composite = calloc(n + 1, 1);
+    uint64_t *factors = allocLimbs(n + 1);
+    size_t count = 0;
+    for (uint64_t p = 2; p <= n; p++) {
+        if (composite[p]) continue;
+        for (uint64_t j = p * p; j <= n; j += p) composite[j] = 1;
+        uint64_t e = legendre(n, p) - legendre(k, p) - legendre(n - k, p);
+        uint64_t pe = 1;   // p^e <= n for binomial coefficients (Kummer)
+        while (e-- > 0) pe *= p;
+        if (pe > 1) factors[count++] = pe;
+    }
+    BigInt r = productOfList(factors, 0, count);
+    free(composite);
+    free(factors);
+    return r;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to print a long number as its first and last digits
+void printAbbreviated(const char *label, const char *digits) {
+    size_t length = strlen(digits);
+    if (length <= 60) {
+        printf("%s = %s\n", label, digits);
+    } else {
+        printf("%s = %.25s...%s (%zu digits)\n", label, digits, digits + length - 25, length);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // The int version stops being correct at 13!
+    BigInt f = bigFactorial(25);
+    char *s = bigToDecimal(&f);
+    printf("25! = %s\n", s);
+    free(s);
+    bigFree(&f);
+
+    BigInt c = bigBinomial(100, 50);
+    s = bigToDecimal(&c);
+    printf("C(100, 50) = %s\n", s);
+    free(s);
+    bigFree(&c);
+
+    uint64_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+    double start = nowSeconds();
+    f = bigFactorial(n);
+    double productTime = nowSeconds() - start;
+    start = nowSeconds();
+    s = bigToDecimal(&f);
+    double convertTime = nowSeconds() - start;
+
+    char label[64];
+    snprintf(label, sizeof(label), "%llu!", (unsigned long long)n);
+    printAbbreviated(label, s);
+    printf("  product: %.3f s, divide-and-conquer conversion: %.3f s\n", productTime, convertTime);
+
+    if (f.n <= 25000) {   // The O(n^2) conversion gets slow quickly
+        start = nowSeconds();
+        char *simple = bigToDecimalSimple(&f);
+        printf("  simple conversion: %.3f s, results match: %s\n", nowSeconds() - start,
+               strcmp(s, simple) == 0 ? "yes" : "no");
+        free(simple);
+    }
+    free(s);
+    bigFree(&f);
+
+    start = nowSeconds();
+    c = bigBinomial(2 * n, n);
+    s = bigToDecimal(&c);
+    snprintf(label, sizeof(label), "C(%llu, %llu)", (unsigned long long)(2 * n), (unsigned long long)n);
+    printAbbreviated(label, s);
+    printf("  total: %.3f s\n", nowSeconds() - start);
+    free(s);
+    bigFree(&c);
+
+    return 0;
+}
@@ -0,0 +1,365 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+    DENSE BITSETS
+
+    Layout:
+    - Bit i lives in word i / 64, at position i % 64 of that word.
+    - The word array is 64-byte aligned and padded to a whole number of
+      512-bit blocks (8 words), so SIMD loops never need a scalar tail.
+      Padding bits are always 0.
+
+    Whole-set operations:
+    - AND, OR, XOR and ANDNOT combine 64 bits per word operation, or 256
+      bits per AVX2 instruction, instead of looping over single bits.
+    - popcount counts set bits. Scalar code uses the POPCNT instruction
+      (__builtin_popcountll). The AVX2 version looks up the count of each
+      4-bit nibble with a byte shuffle (Mula's method) and adds the bytes
+      up with _mm256_sad_epu8.
+    - bitsetAndCount() counts |A AND B| without writing the result.
+
+    Queries:
+    - bitsetNext(): the first set bit at or after a position. Whole zero
+      words are skipped, and __builtin_ctzll finds the bit in a word.
+    - bitsetRank(i): how many set bits come before position i.
+      bitsetBuildRank() stores the running count at the start of every
+      512-bit block; a query adds popcounts of at most 8 words.
+    - bitsetSelect(k): the position of the k-th set bit (counting from 0).
+      bitsetBuildRank() also remembers the block of every 4096th set bit,
+      which narrows the binary search over the block counts to a few
+      steps. The words of the block are then scanned, and the bit inside
+      the word is found with PDEP (BMI2) or by clearing the lowest set bit
+      k times.
+*/
+
+#define WORD_BITS 64
+#define BLOCK_WORDS 8    // 512 bits = one cache line
+#define SELECT_SAMPLE 4096
+
+typedef struct {
+    uint64_t *words;
+    size_t bits;         // Size of the set in bits
+    size_t wordCount;    // Always a multiple of BLOCK_WORDS
+    uint64_t *ranks;     // Set bits before each block (built by bitsetBuildRank)
+    size_t *samples;     // samples[j]: block holding set bit number j * SELECT_SAMPLE
+} Bitset;
+
+// Function to create a bitset with all bits cleared; returns 0 on success
+int bitsetInit(Bitset *b, size_t bits) {
+    size_t blocks = (bits + BLOCK_WORDS * WORD_BITS - 1) / (BLOCK_WORDS * WORD_BITS);
+    b->bits = bits;
+    b->wordCount = (blocks > 0 ? blocks : 1) * BLOCK_WORDS;
+    b->words = aligned_alloc(64, b->wordCount * sizeof(uint64_t));
+    b->ranks = NULL;
+    b->samples = NULL;
+    if (b->words == NULL) return -1;
+    memset(b->words, 0, b->wordCount * sizeof(uint64_t));
+    return 0;
+}
+
+void bitsetFree(Bitset *b) {
+    free(b->words);
+    free(b->ranks);
+    free(b->samples);
+    b->words = b->ranks = NULL;
+    b->samples = NULL;
+}
+
+static inline void bitsetSet(Bitset *b, size_t i) {
+    b->words[i / WORD_BITS] |= 1ULL << (i % WORD_BITS);
+}
+
+static inline void bitsetClear(Bitset *b, size_t i) {
+    b->words[i / WORD_BITS] &= ~(1ULL << (i % WORD_BITS));
+}
+
+static inline int bitsetTest(const Bitset *b, size_t i) {
+    return (b->words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+}
+
+/* ---------- Whole-set operations ---------- */
+
+typedef enum { OP_AND, OP_OR, OP_XOR, OP_ANDNOT } SetOp;
+
+// Function to compute dst = a OP b (all three must have the same size; dst may be a or b)
+void bitsetCombine(Bitset *dst, const Bitset *a, const Bitset *b, SetOp op) {
+    size_t n = dst->wordCount;
+#ifdef __AVX2__
+    for (size_t i = 0; i < n; i += 4) {
+        __m256i x = _mm256_load_si256((const __m256i *)(a->words + i));
+        __m256i y = _mm256_load_si256((const __m256i *)(b->words + i));
+        __m256i r;
+        switch (op) {
+            case OP_AND:    r = _mm256_and_si256(x, y); break;
+            case OP_OR:     r = _mm256_or_si256(x, y); break;
+            case OP_XOR:    r = _mm256_xor_si256(x, y); break;
+            default:        r = _mm256_andnot_si256(y, x); break;    // x AND NOT y
+        }
+        _mm256_store_si256((__m256i *)(dst->words + i), r);
+    }
+#else
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = a->words[i], y = b->words[i];
+        dst->words[i] = op == OP_AND ? x & y : op == OP_OR ? x | y : op == OP_XOR ? x ^ y : x & ~y;
+    }
+#endif
+    free(dst->ranks);    // The rank index no longer matches
+    free(dst->samples);
+    dst->ranks = NULL;
+    dst->samples = NULL;
+}
+
+#ifdef __AVX2__
+// Function to count the set bits in each 64-bit lane of v
+static inline __m256i popcount256(__m256i v) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low4 = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low4));
+    __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+static inline uint64_t sumLanes(__m256i v) {
+    return (uint64_t)_mm256_extract_epi64(v, 0) + (uint64_t)_mm256_extract_epi64(v, 1) +
+           (uint64_t)_mm256_extract_epi64(v, 2) + (uint64_t)_mm256_extract_epi64(v, 3);
+}
+#endif
+
+// Function to count the set bits in words[0..n), n a multiple of BLOCK_WORDS
+uint64_t popcountWords(const uint64_t *words, size_t n) {
+#ifdef __AVX2__
+    __m256i total = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 8) {
+        __m256i x = _mm256_load_si256((const __m256i *)(words + i));
+        __m256i y = _mm256_load_si256((const __m256i *)(words + i + 4));
+        total = _mm256_add_epi64(total, _mm256_add_epi64(popcount256(x), popcount256(y)));
+    }
+    return sumLanes(total);
+#else
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) total += __builtin_popcountll(words[i]);
+    return total;
+#endif
+}
+
+uint64_t bitsetCount(const Bitset *b) {
+    return popcountWords(b->words, b->wordCount);
+}
+
+// Function to count |a AND b| without storing the intersection
+uint64_t bitsetAndCount(const Bitset *a, const Bitset *b) {
+    size_t n = a->wordCount;
+#ifdef __AVX2__
+    __m256i total = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 4) {
+        __m256i x = _mm256_load_si256((const __m256i *)(a->words + i));
+        __m256i y = _mm256_load_si256((const __m256i *)(b->words + i));
+        total = _mm256_add_epi64(total, popcount256(_mm256_and_si256(x, y)));
+    }
+    return sumLanes(total);
+#else
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) total += __builtin_popcountll(a->words[i] & b->words[i]);
+    return total;
+#endif
+}
+
+/* ---------- Queries ---------- */
+
+// Function to find the first set bit at position >= from; returns b->bits if there is none
+size_t bitsetNext(const Bitset *b, size_t from) {
+    if (from >= b->bits) return b->bits;
+    size_t w = from / WORD_BITS;
+    uint64_t word = b->words[w] & (~0ULL << (from % WORD_BITS));
+    while (word == 0) {
+        if (++w == b->wordCount) return b->bits;
+        word = b->words[w];
+    }
+    return w * WORD_BITS + __builtin_ctzll(word);
+}
+
+// Function to build the rank and select index; returns 0 on success
+int bitsetBuildRank(Bitset *b) {
+    size_t blocks = b->wordCount / BLOCK_WORDS;
+    free(b->ranks);
+    free(b->samples);
+    b->ranks = malloc((blocks + 1) * sizeof(uint64_t));
+    b->samples = malloc((blocks * BLOCK_WORDS * WORD_BITS / SELECT_SAMPLE + 2) * sizeof(size_t));
+    if (b->ranks == NULL || b->samples == NULL) return -1;
+    uint64_t total = 0;
+    size_t sampleCount = 0;
+    for (size_t k = 0; k < blocks; k++) {
+        b->ranks[k] = total;
+        total += popcountWords(b->words + k * BLOCK_WORDS, BLOCK_WORDS);
+        while (sampleCount * SELECT_SAMPLE < total) b->samples[sampleCount++] = k;
+    }
+    b->ranks[blocks] = total;
+    b->samples[sampleCount] = blocks - 1;    // Upper bound for the last search
+    return 0;
+}
+
+// Function to count the set bits before position i (needs bitsetBuildRank)
+uint64_t bitsetRank(const Bitset *b, size_t i) {
+    if (i >= b->bits) return b->ranks[b->wordCount / BLOCK_WORDS];
+    size_t w = i / WORD_BITS;
+    uint64_t count = b->ranks[w / BLOCK_WORDS];
+    for (size_t j = w - w % BLOCK_WORDS; j < w; j++) count += __builtin_popcountll(b->words[j]);
+    return count + __builtin_popcountll(b->words[w] & ((1ULL << (i % WORD_BITS)) - 1));
+}
+
+// Function to find the position of the k-th set bit inside one word (k < popcount(word))
+static inline int selectInWord(uint64_t word, unsigned k) {
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(1ULL << k, word));
+#else
+    while (k-- > 0) word &= word - 1;    // Clear the lowest set bit k times
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Function to find the position of the k-th set bit, counting from 0 (needs bitsetBuildRank)
+// Returns b->bits if the set has k or fewer bits
+size_t bitsetSelect(const Bitset *b, uint64_t k) {
+    size_t blocks = b->wordCount / BLOCK_WORDS;
+    if (k >= b->ranks[blocks]) return b->bits;
+    // Last block whose starting rank is <= k; it lies between two samples
+    size_t lo = b->samples[k / SELECT_SAMPLE], hi = b->samples[k / SELECT_SAMPLE + 1] + 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (b->ranks[mid] <= k) lo = mid;
+        else hi = mid;
+    }
+    k -= b->ranks[lo];
+    size_t w = lo * BLOCK_WORDS;
+    for (;;) {
+        unsigned c = __builtin_popcountll(b->words[w]);
+        if (k < c) break;
+        k -= c;
+        w++;
+    }
+    return w * WORD_BITS + selectInWord(b->words[w], (unsigned)k);
+}
+
+/* ---------- Demo and benchmark ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+void printSet(const char *name, const Bitset *b) {
+    printf("%s: {", name);
+    for (size_t i = bitsetNext(b, 0); i < b->bits; i = bitsetNext(b, i + 1)) printf(" %zu", i);
+    printf(" }  count %llu\n", (unsigned long long)bitsetCount(b));
+}
+
+int main(int argc, char *argv[]) {
+    // Small sets: the same operators as on a single int, but on sets of any size
+    Bitset a, b, r;
+    if (bitsetInit(&a, 100) || bitsetInit(&b, 100) || bitsetInit(&r, 100)) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    for (size_t i = 0; i < 100; i += 3) bitsetSet(&a, i);      // Multiples of 3
+    for (size_t i = 0; i < 100; i += 5) bitsetSet(&b, i);      // Multiples of 5
+    bitsetClear(&a, 99);
+    bitsetCombine(&r, &a, &b, OP_AND);
+    printSet("3 AND 5", &r);
+    bitsetCombine(&r, &a, &b, OP_XOR);
+    bitsetCombine(&r, &r, &b, OP_ANDNOT);
+    printSet("3 XOR 5, without 5", &r);
+    bitsetBuildRank(&a);
+    printf("Multiples of 3 below 50: %llu, the 10th (from 0) is %zu, 42 is %s\n",
+           (unsigned long long)bitsetRank(&a, 50), bitsetSelect(&a, 10), bitsetTest(&a, 42) ? "in" : "out");
+    bitsetFree(&a); bitsetFree(&b); bitsetFree(&r);
+
+    // Large sets
+    size_t bits = argc > 1 ? (size_t)atoll(argv[1]) : (size_t)1 << 28;
+    Bitset x, y, z;
+    if (bitsetInit(&x, bits) || bitsetInit(&y, bits) || bitsetInit(&z, bits)) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < bits / WORD_BITS; i++) {
+        x.words[i] = nextRandom(&state) & nextRandom(&state);    // About 25% of bits set
+        y.words[i] = nextRandom(&state) | nextRandom(&state);    // About 75%
+    }
+    printf("\n%zu bits (%zu MB per set)\n", bits, x.wordCount * 8 >> 20);
+
+    // AND + count, three ways
+    double start = nowSeconds();
+    uint64_t perBit = 0;
+    for (size_t i = 0; i < bits; i++) perBit += bitsetTest(&x, i) & bitsetTest(&y, i);
+    double perBitTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    bitsetCombine(&z, &x, &y, OP_AND);
+    uint64_t combined = bitsetCount(&z);
+    double combineTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    uint64_t fused = bitsetAndCount(&x, &y);
+    double fusedTime = nowSeconds() - start;
+
+    printf("|x AND y| = %llu\n", (unsigned long long)fused);
+    printf("  bit by bit:           %8.2f ms\n", perBitTime * 1e3);
+    printf("  AND, then popcount:   %8.2f ms\n", combineTime * 1e3);
+    printf("  fused AND + popcount: %8.2f ms (%.1f GB/s)\n", fusedTime * 1e3,
+           2.0 * x.wordCount * 8 / fusedTime / 1e9);
+
+    // Iterate over the set bits of the intersection
+    start = nowSeconds();
+    uint64_t visited = 0;
+    for (size_t i = bitsetNext(&z, 0); i < bits; i = bitsetNext(&z, i + 1)) visited++;
+    double iterateTime = nowSeconds() - start;
+    printf("Visiting every set bit: %.2f ms (%.2f ns per bit)\n", iterateTime * 1e3, iterateTime * 1e9 / visited);
+
+    // Rank and select
+    start = nowSeconds();
+    if (bitsetBuildRank(&z)) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    double buildTime = nowSeconds() - start;
+    int queries = 1000000;
+    int ok = 1;
+    uint64_t checksum = 0;
+    start = nowSeconds();
+    for (int q = 0; q < queries; q++) checksum += bitsetRank(&z, nextRandom(&state) % bits);
+    double rankTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int q = 0; q < queries; q++) {
+        uint64_t k = nextRandom(&state) % fused;
+        size_t pos = bitsetSelect(&z, k);
+        checksum += pos;
+        if (q % 1000 == 0) ok &= bitsetTest(&z, pos) && bitsetRank(&z, pos) == k;    // select and rank agree
+    }
+    double selectTime = nowSeconds() - start;
+    printf("Rank/select index: %.2f ms to build, %zu KB\n", buildTime * 1e3,
+           ((z.wordCount / BLOCK_WORDS + 1) * 8 + (fused / SELECT_SAMPLE + 2) * sizeof(size_t)) >> 10);
+    printf("  rank:   %.1f ns per query\n", rankTime * 1e9 / queries);
+    printf("  select: %.1f ns per query\n", selectTime * 1e9 / queries);
+    printf("Checks: %s (checksum %llu)\n",
+           ok && perBit == fused && combined == fused && visited == fused ? "ok" : "FAILED",
+           (unsigned long long)checksum);
+
+    bitsetFree(&x); bitsetFree(&y); bitsetFree(&z);
+    return 0;
+}
@@ -0,0 +1,632 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+    LZ77 BLOCK COMPRESSION (LZ4 STYLE)
+
+    The Idea:
+    - Text, and logs in particular, repeat themselves. LZ77 replaces a
+      repeated piece with a reference to its earlier occurrence:
+      "copy 23 bytes from 1,250 bytes back".
+    - The output is a list of sequences. Each sequence is some literal bytes
+      (copied as they are), followed by one match (offset + length).
+
+    The Sequence Format (the same layout as LZ4 blocks):
+        token    1 byte: high 4 bits = literal length, low 4 bits = match length - 4
+                 (15 means "more length bytes follow": 255, 255, ..., rest)
+        literals
+        offset   2 bytes, little-endian (1 to 65535)
+    - The last sequence of a block has literals only.
+
+    Speed:
+    - The compressor finds matches with a hash table of recent positions and
+      takes the first match it finds (greedy), skipping faster through data
+      that does not compress.
+    - The decompressor only copies bytes. It copies 16 bytes at a time even
+      when fewer are needed, into buffers with spare room at the end.
+    - Short literals followed by a match of up to 32 bytes, far from the
+      block's end, are decoded with one range check and three fixed-size
+      copies. This is the common sequence in text.
+
+    The Frame Format:
+        "LZB1"  block size log (1 byte)  3 zero bytes
+        for each block: compressed size (4 bytes, bit 31 = stored
+                        uncompressed), original size (4 bytes), data
+        end mark: 8 zero bytes
+    - Blocks are independent, so threads compress and decompress different
+      blocks at the same time. The blocks are written in input order.
+
+    Usage:
+        block_compressor -c IN OUT [-j threads]
+        block_compressor -d IN OUT [-j threads]
+        block_compressor -b [FILE]          (benchmark, default: generated logs)
+*/
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5        // The last 5 bytes of a block are always literals
+#define MF_LIMIT 12            // No match starts in the last 12 bytes
+#define MAX_OFFSET 65535
+#define HASH_BITS 16
+#define SLACK 32               // Spare bytes after buffers for 16-byte copies
+#define BLOCK_LOG 20           // 1 MB blocks
+#define MAX_THREADS 64
+#define RAW_FLAG 0x80000000u
+
+/* ---------- Block compression ---------- */
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Function to count how many bytes match, 8 at a time
+static inline size_t matchLength(const uint8_t *a, const uint8_t *b, const uint8_t *limit) {
+    const uint8_t *start = a;
+    while (a + 8 <= limit) {
+        uint64_t diff = read64(a) ^ read64(b);
+        if (diff != 0) return a - start + (__builtin_ctzll(diff) >> 3);
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) a++, b++;
+    return a - start;
+}
+
+// Function to write a length that did not fit into 4 bits
+static inline uint8_t *writeLength(uint8_t *op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Function to give the largest possible compressed size of n bytes
+size_t compressBound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+// Function to compress one block; dst needs compressBound(n) bytes, table 1 << HASH_BITS entries
+size_t compressBlock(const uint8_t *src, size_t n, uint8_t *dst, uint32_t *table) {
+    const uint8_t *anchor = src, *ip = src;
+    const uint8_t *end = src + n;
+    const uint8_t *matchLimit = end - LAST_LITERALS;
+    uint8_t *op = dst;
+    memset(table, 0, sizeof(uint32_t) << HASH_BITS);
+
+    if (n > MF_LIMIT) {
+        const uint8_t *limit = end - MF_LIMIT;
+        unsigned misses = 0;
+        ip++;
+        while (ip < limit) {
+            uint32_t sequence = read32(ip);
+            uint32_t h = hash4(sequence);
+            const uint8_t *candidate = src + table[h];
+            table[h] = (uint32_t)(ip - src);
+            if (candidate >= ip || ip - candidate > MAX_OFFSET || read32(candidate) != sequence) {
+                // Skip faster and faster through data that does not compress
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            // Extend the match backwards into the pending literals
+            while (ip > anchor && candidate > src && ip[-1] == candidate[-1]) ip--, candidate--;
+            size_t length = MIN_MATCH + matchLength(ip + MIN_MATCH, candidate + MIN_MATCH, matchLimit);
+
+            size_t literals = ip - anchor, code = length - MIN_MATCH;
+            uint8_t *token = op++;
+            *token = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (code < 15 ? code : 15));
+            if (literals >= 15) op = writeLength(op, literals - 15);
+            memcpy(op, anchor, literals);
+            op += literals;
+            size_t offset = ip - candidate;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (code >= 15) op = writeLength(op, code - 15);
+
+            ip += length;
+            anchor = ip;
+            // Remember a position inside the match too; it often starts the next one
+            if (ip < limit) table[hash4(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+        }
+    }
+    // Last sequence: literals only
+    size_t literals = end - anchor;
+    *op++ = (uint8_t)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) op = writeLength(op, literals - 15);
+    memcpy(op, anchor, literals);
+    return op + literals - dst;
+}
+
+/* ---------- Block decompression ---------- */
+
+// Function to decompress one block into exactly dstLength bytes; returns 0, or -1 if the data is corrupt
+// Both buffers need SLACK spare bytes after their end.
+int decompressBlock(const uint8_t *src, size_t srcLength, uint8_t *dst, size_t dstLength) {
+    // For offsets below 8: after 4 bytes copied one by one, these steps move 'match' to the
+    // source of op + 8, a whole number of periods of at least 8 back (the same tables as LZ4)
+    static const unsigned increment[8] = {0, 1, 2, 1, 0, 4, 4, 4};
+    static const int decrement[8] = {0, 0, 0, -1, -4, 1, 2, 3};
+    const uint8_t *ip = src, *iend = src + srcLength;
+    uint8_t *op = dst, *oend = dst + dstLength;
+    for (;;) {
+        if (ip >= iend) return -1;
+        unsigned token = *ip++;
+        size_t literals = token >> 4, offset, length;
+
+        if (literals < 15 && iend - ip >= 32 && oend - op >= 64) {
+            // Common case: fewer than 15 literals, far from both ends. One 16-byte copy covers
+            // the literals, and a match of up to 32 bytes is two more copies, with no loops.
+            memcpy(op, ip, 16);
+            ip += literals;
+            op += literals;
+            offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            length = (token & 15) + MIN_MATCH;
+            if (length == 15 + MIN_MATCH) {
+                unsigned b;
+                do {
+                    if (ip >= iend) return -1;
+                    b = *ip++;
+                    length += b;
+                } while (b == 255);
+            }
+            if (offset >= 16 && length <= 32 && offset <= (size_t)(op - dst)) {
+                memcpy(op, op - offset, 16);
+                memcpy(op + 16, op - offset + 16, 16);
+                op += length;
+                continue;
+            }
+        } else {
+            if (literals < 15 && iend - ip >= 16 && oend - op >= 16) {
+                memcpy(op, ip, 16);
+            } else {
+                if (literals == 15) {
+                    unsigned b;
+                    do {
+                        if (ip >= iend) return -1;
+                        b = *ip++;
+                        literals += b;
+                    } while (b == 255);
+                }
+                if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op)) return -1;
+                for (size_t i = 0; i < literals; i += 32) {
+                    memcpy(op + i, ip + i, 16);
+                    memcpy(op + i + 16, ip + i + 16, 16);
+                }
+            }
+            ip += literals;
+            op += literals;
+            if (ip == iend) break;             // The last sequence has no match
+
+            if (iend - ip < 2) return -1;
+            offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            length = token & 15;
+            if (length == 15) {
+                unsigned b;
+                do {
+                    if (ip >= iend) return -1;
+                    b = *ip++;
+                    length += b;
+                } while (b == 255);
+            }
+            length += MIN_MATCH;
+        }
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+        if (length > (size_t)(oend - op)) return -1;
+
+        // The match may overlap the bytes it produces (offset < length), which repeats a pattern
+        const uint8_t *match = op - offset;
+        if (offset >= 16 && length <= 32 && oend - op >= 32) {
+            memcpy(op, match, 16);         // Short match: two copies, no loop
+            memcpy(op + 16, match + 16, 16);
+        } else if (offset >= 16) {
+            for (size_t i = 0; i < length; i += 16) memcpy(op + i, match + i, 16);
+        } else if (offset >= 8) {
+            for (size_t i = 0; i < length; i += 8) memcpy(op + i, match + i, 8);
+        } else {
+            // Short pattern: 4 bytes one by one, 4 more from a shifted start, then 8 at a time
+            op[0] = match[0];
+            op[1] = match[1];
+            op[2] = match[2];
+            op[3] = match[3];
+            match += increment[offset];
+            memcpy(op + 4, match, 4);
+            match -= decrement[offset];
+            for (size_t i = 8; i < length; i += 8) memcpy(op + i, match + i - 8, 8);
+        }
+        op += length;
+    }
+    return op == oend ? 0 : -1;
+}
+
+/* ---------- Parallel block jobs ---------- */
+
+typedef struct {
+    uint8_t *in;               // SLACK spare bytes after the block
+    size_t inLength;
+    uint8_t *out;
+    size_t outLength;          // Compress: result; decompress: expected size
+    int raw;                   // Stored uncompressed
+    int failed;
+    uint32_t *table;
+} BlockJob;
+
+void *compressJob(void *arg) {
+    BlockJob *job = arg;
+    job->outLength = compressBlock(job->in, job->inLength, job->out, job->table);
+    job->raw = job->outLength >= job->inLength;
+    return NULL;
+}
+
+void *decompressJob(void *arg) {
+    BlockJob *job = arg;
+    if (job->raw) {
+        memcpy(job->out, job->in, job->outLength);
+    } else {
+        job->failed = decompressBlock(job->in, job->inLength, job->out, job->outLength) != 0;
+    }
+    return NULL;
+}
+
+// Function to run jobs on up to 'count' threads; the calling thread takes the first job
+void runJobs(BlockJob *jobs, int count, void *(*work)(void *)) {
+    pthread_t ids[MAX_THREADS];
+    int started[MAX_THREADS] = {0};
+    for (int i = 1; i < count; i++) started[i] = pthread_create(&ids[i], NULL, work, &jobs[i]) == 0;
+    work(&jobs[0]);
+    for (int i = 1; i < count; i++) {
+        if (started[i]) pthread_join(ids[i], NULL);
+        else work(&jobs[i]);
+    }
+}
+
+/* ---------- Files ---------- */
+
+int writeAll(int fd, const void *buffer, size_t n) {
+    const uint8_t *p = buffer;
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= w;
+    }
+    return 0;
+}
+
+ssize_t readFull(int fd, void *buffer, size_t n) {
+    uint8_t *p = buffer;
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = read(fd, p + got, n - got);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break;
+        got += r;
+    }
+    return got;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Function to allocate the buffers of 'threads' jobs; returns 0 on success
+int allocateJobs(BlockJob *jobs, int threads, size_t blockSize, int withTables) {
+    memset(jobs, 0, sizeof(BlockJob) * threads);
+    for (int i = 0; i < threads; i++) {
+        jobs[i].in = malloc(compressBound(blockSize) + SLACK);
+        jobs[i].out = malloc(compressBound(blockSize) + SLACK);
+        jobs[i].table = withTables ? malloc(sizeof(uint32_t) << HASH_BITS) : NULL;
+        if (jobs[i].in == NULL || jobs[i].out == NULL || (withTables && jobs[i].table == NULL)) return -1;
+    }
+    return 0;
+}
+
+void freeJobs(BlockJob *jobs, int threads) {
+    for (int i = 0; i < threads; i++) {
+        free(jobs[i].in);
+        free(jobs[i].out);
+        free(jobs[i].table);
+    }
+}
+
+// Function to compress file descriptor 'in' to 'out'; returns 0 on success
+int compressFile(int in, int out, int threads, uint64_t *inBytes, uint64_t *outBytes) {
+    size_t blockSize = (size_t)1 << BLOCK_LOG;
+    BlockJob jobs[MAX_THREADS];
+    int status = -1;
+    if (allocateJobs(jobs, threads, blockSize, 1) != 0) {
+        printf("Out of memory.\n");
+        goto done;
+    }
+    uint8_t header[8] = {'L', 'Z', 'B', '1', BLOCK_LOG, 0, 0, 0};
+    if (writeAll(out, header, 8) != 0) goto done;
+    *outBytes = 8;
+    *inBytes = 0;
+    int last = 0;
+    while (!last) {
+        // Read one block per thread, compress them together, write them in order
+        int count = 0;
+        while (count < threads) {
+            ssize_t n = readFull(in, jobs[count].in, blockSize);
+            if (n < 0) goto done;
+            if (n == 0) {
+                last = 1;
+                break;
+            }
+            jobs[count++].inLength = n;
+            *inBytes += n;
+            if ((size_t)n < blockSize) {
+                last = 1;
+                break;
+            }
+        }
+        if (count == 0) break;
+        runJobs(jobs, count, compressJob);
+        for (int i = 0; i < count; i++) {
+            BlockJob *job = &jobs[i];
+            const uint8_t *data = job->raw ? job->in : job->out;
+            size_t length = job->raw ? job->inLength : job->outLength;
+            uint8_t blockHeader[8];
+            put32(blockHeader, (uint32_t)length | (job->raw ? RAW_FLAG : 0));
+            put32(blockHeader + 4, (uint32_t)job->inLength);
+            if (writeAll(out, blockHeader, 8) != 0 || writeAll(out, data, length) != 0) goto done;
+            *outBytes += 8 + length;
+        }
+    }
+    uint8_t endMark[8] = {0};
+    if (writeAll(out, endMark, 8) != 0) goto done;
+    *outBytes += 8;
+    status = 0;
+done:
+    freeJobs(jobs, threads);
+    return status;
+}
+
+// Function to decompress 'in' to 'out'; returns 0 on success, -1 on I/O error, -2 on bad data
+int decompressFile(int in, int out, int threads, uint64_t *inBytes, uint64_t *outBytes) {
+    uint8_t header[8];
+    if (readFull(in, header, 8) != 8 || memcmp(header, "LZB1", 4) != 0 || header[4] < 10 || header[4] > 24) {
+        return -2;
+    }
+    size_t blockSize = (size_t)1 << header[4];
+    BlockJob jobs[MAX_THREADS];
+    int status = -1;
+    if (allocateJobs(jobs, threads, blockSize, 0) != 0) {
+        printf("Out of memory.\n");
+        goto done;
+    }
+    *inBytes = 8;
+    *outBytes = 0;
+    int last = 0;
+    while (!last) {
+        int count = 0;
+        while (count < threads) {
+            uint8_t blockHeader[8];
+            if (readFull(in, blockHeader, 8) != 8) {
+                status = -2;              // Truncated: no end mark
+                goto done;
+            }
+            uint32_t stored = get32(blockHeader), original = get32(blockHeader + 4);
+            if (stored == 0 && original == 0) {
+                last = 1;
+                break;
+            }
+            BlockJob *job = &jobs[count];
+            job->raw = (stored & RAW_FLAG) != 0;
+            job->inLength = stored & ~RAW_FLAG;
+            job->outLength = original;
+            job->failed = 0;
+            if (original > blockSize || job->inLength > compressBound(blockSize) ||
+                (job->raw && job->inLength != original)) {
+                status = -2;
+                goto done;
+            }
+            if (readFull(in, job->in, job->inLength) != (ssize_t)job->inLength) {
+                status = -2;
+                goto done;
+            }
+            *inBytes += 8 + job->inLength;
+            count++;
+        }
+        if (count == 0) break;
+        runJobs(jobs, count, decompressJob);
+        for (int i = 0; i < count; i++) {
+            if (jobs[i].failed) {
+                status = -2;
+                goto done;
+            }
+            if (writeAll(out, jobs[i].out, jobs[i].outLength) != 0) goto done;
+            *outBytes += jobs[i].outLength;
+        }
+    }
+    *inBytes += 8;
+    status = 0;
+done:
+    freeJobs(jobs, threads);
+    return status;
+}
+
+/* ---------- Benchmark ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to fill a buffer with log lines like a typical service writes
+size_t generateLogs(char *p, size_t size) {
+    static const char *levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+    static const char *messages[] = {
+        "request completed", "cache miss for key", "connection opened from",
+        "retrying upstream call to", "slow query detected on table", "user session refreshed",
+    };
+    uint64_t state = 88172645463325252ULL;
+    size_t length = 0;
+    unsigned long long millis = 1700000000000ULL;
+    while (length + 200 < size) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        millis += state % 50;
+        int m = (state >> 8) % 6;
+        length += sprintf(p + length, "%llu.%03llu %-5s [worker-%llu] %s id=%llu latency_ms=%llu\n",
+                          millis / 1000, millis % 1000, levels[(state >> 16) % 6], (unsigned long long)(state >> 24) % 8,
+                          messages[m], (unsigned long long)(state >> 32) % 100000, (unsigned long long)(state >> 48) % 2000);
+    }
+    return length;
+}
+
+// Function to compress and decompress an in-memory buffer block by block, checking the round trip
+int benchmark(const char *path) {
+    size_t size;
+    uint8_t *data;
+    if (path != NULL) {
+        int fd = open(path, O_RDONLY);
+        off_t end = fd < 0 ? -1 : lseek(fd, 0, SEEK_END);
+        if (fd < 0 || end < 0) {
+            perror(path);
+            return 1;
+        }
+        size = end;
+        data = malloc(size + SLACK);
+        if (data == NULL || pread(fd, data, size, 0) != (ssize_t)size) {
+            perror(path);
+            return 1;
+        }
+        close(fd);
+    } else {
+        size = 256 << 20;
+        data = malloc(size + SLACK);
+        if (data == NULL) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        size = generateLogs((char *)data, size);
+    }
+    size_t blockSize = (size_t)1 << BLOCK_LOG;
+    size_t blocks = (size + blockSize - 1) / blockSize;
+    uint8_t *packed = malloc(blocks * (compressBound(blockSize) + SLACK));
+    size_t *packedLength = malloc(blocks * sizeof(size_t));
+    uint8_t *restored = malloc(size + SLACK);
+    uint32_t *table = malloc(sizeof(uint32_t) << HASH_BITS);
+    if (packed == NULL || packedLength == NULL || restored == NULL || table == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    // Touch the output buffers first, so page faults are not timed
+    memset(packed, 0, blocks * (compressBound(blockSize) + SLACK));
+    memset(restored, 0, size);
+    double start = nowSeconds();
+    memcpy(restored, data, size);
+    double copyTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    size_t total = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        size_t n = b == blocks - 1 ? size - b * blockSize : blockSize;
+        packedLength[b] = compressBlock(data + b * blockSize, n, packed + b * (compressBound(blockSize) + SLACK), table);
+        total += packedLength[b];
+    }
+    double compressTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    int ok = 1;
+    for (size_t b = 0; b < blocks; b++) {
+        size_t n = b == blocks - 1 ? size - b * blockSize : blockSize;
+        ok &= decompressBlock(packed + b * (compressBound(blockSize) + SLACK), packedLength[b],
+                              restored + b * blockSize, n) == 0;
+    }
+    double decompressTime = nowSeconds() - start;
+    ok &= memcmp(data, restored, size) == 0;
+
+    printf("Input:       %.1f MB (%s)\n", size / 1e6, path != NULL ? path : "generated log lines");
+    printf("Compressed:  %.1f MB, ratio %.2f\n", total / 1e6, (double)size / total);
+    printf("Compress:    %7.0f MB/s\n", size / compressTime / 1e6);
+    printf("Decompress:  %7.0f MB/s\n", size / decompressTime / 1e6);
+    printf("memcpy:      %7.0f MB/s\n", size / copyTime / 1e6);
+    printf("Round trip:  %s\n", ok ? "ok" : "FAILED");
+    free(data);
+    free(packed);
+    free(packedLength);
+    free(restored);
+    free(table);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc >= 5 && strcmp(argv[argc - 2], "-j") == 0) {
+        threads = atoi(argv[argc - 1]);
+        argc -= 2;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    if (argc >= 2 && argc <= 3 && strcmp(argv[1], "-b") == 0) return benchmark(argc == 3 ? argv[2] : NULL);
+    if (argc != 4 || (strcmp(argv[1], "-c") != 0 && strcmp(argv[1], "-d") != 0)) {
+        fprintf(stderr, "Usage: %s -c|-d IN OUT [-j threads] | %s -b [FILE]\n", argv[0], argv[0]);
+        return 2;
+    }
+    int in = open(argv[2], O_RDONLY);
+    if (in < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    int out = open(argv[3], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        perror(argv[3]);
+        return 1;
+    }
+    uint64_t inBytes = 0, outBytes = 0;
+    double start = nowSeconds();
+    int compress = argv[1][1] == 'c';
+    int status = compress ? compressFile(in, out, threads, &inBytes, &outBytes)
+                          : decompressFile(in, out, threads, &inBytes, &outBytes);
+    double seconds = nowSeconds() - start;
+    close(in);
+    if (close(out) != 0 && status == 0) status = -1;
+    if (status == -2) {
+        fprintf(stderr, "%s: not a valid LZB1 file or corrupt data\n", argv[2]);
+        return 1;
+    }
+    if (status != 0) {
+        perror(compress ? "compress" : "decompress");
+        return 1;
+    }
+    uint64_t plain = compress ? inBytes : outBytes, packed = compress ? outBytes : inBytes;
+    fprintf(stderr, "%llu -> %llu bytes (ratio %.2f), %.0f MB/s, %d threads\n",
+            (unsigned long long)inBytes, (unsigned long long)outBytes,
+            packed > 0 ? (double)plain / packed : 0.0, plain / seconds / 1e6, threads);
+    return 0;
+}
@@ -0,0 +1,639 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+/*
+    AN ON-DISK B+TREE INDEX
+
+    Finding a Record by Key:
+    - lseek() and read() can fetch any part of a file, but only if the
+      offset is known. Without an index, finding a key means reading the
+      file from the start until the key turns up.
+
+    The B+tree:
+    - The file is split into fixed-size pages of 4096 bytes, and page
+      number n is at offset n * 4096. Every access reads exactly one page
+      with pread(), which is lseek() and read() in one call.
+    - Leaf pages hold the records, sorted by key, and each leaf points to
+      the next one. Internal pages hold keys and the page numbers of their
+      children: child i contains the keys from keys[i] up to keys[i + 1].
+    - An internal page has 340 children, so three levels reach about 14.7
+      million records. A lookup reads one page per level.
+
+    Bulk Loading:
+    - Sorted input can be loaded bottom-up: records fill a leaf until it
+      is full; each full page is written and its first key is added to the
+      page one level higher, which fills up in the same way. Every page is
+      written once, completely full, and no page is ever split.
+
+    Buffer Pool:
+    - The upper levels are read by every lookup. A small pool keeps
+      recently used pages in memory, so most lookups need only one or two
+      reads. When the pool is full, the CLOCK algorithm picks a page that
+      was not used recently.
+
+    Usage:
+        btree_index FILE generate N         sorted text input: KEY VALUE lines
+        btree_index FILE build INPUT        bulk load (INPUT must be sorted)
+        btree_index FILE get KEY...
+        btree_index FILE range FROM TO
+        btree_index FILE bench INPUT [N]    cold and warm lookups vs a linear scan
+*/
+
+#define PAGE_SIZE 4096
+#define VALUE_SIZE 24
+#define MAX_HEIGHT 8
+#define POOL_FRAMES 64
+
+enum { PAGE_LEAF = 1, PAGE_INTERNAL = 2 };
+
+typedef struct {
+    char magic[8];              // "BPTREE01"
+    uint32_t pageSize;
+    uint32_t height;            // 1 when the root is a leaf
+    uint32_t rootPage;
+    uint32_t pageCount;
+    uint64_t keyCount;
+} Header;
+
+typedef struct {
+    uint16_t type;
+    uint16_t count;
+    uint32_t next;              // Leaves: the next leaf, 0 after the last one
+    uint64_t reserved;
+} PageHeader;
+
+typedef struct {
+    uint64_t key;
+    char value[VALUE_SIZE];     // Padded with '\0', not terminated when full
+} Record;
+
+#define LEAF_CAPACITY ((PAGE_SIZE - sizeof(PageHeader)) / sizeof(Record))
+#define INTERNAL_CAPACITY ((PAGE_SIZE - sizeof(PageHeader)) / (sizeof(uint64_t) + sizeof(uint32_t)))
+
+typedef union {
+    unsigned char bytes[PAGE_SIZE];
+    PageHeader header;
+    struct {
+        PageHeader header;
+        Record records[LEAF_CAPACITY];
+    } leaf;
+    struct {
+        PageHeader header;
+        uint64_t keys[INTERNAL_CAPACITY];
+        uint32_t children[INTERNAL_CAPACITY];
+    } internal;
+    Header file;                // Page 0
+} Page;
+
+_Static_assert(sizeof(Page) == PAGE_SIZE, "a page must be exactly PAGE_SIZE bytes");
+
+/* ---------- Page I/O ---------- */
+
+// Function to read page 'number' into 'page'; returns 0 on success
+int readPage(int fd, uint32_t number, Page *page) {
+    ssize_t got;
+    do {
+        got = pread(fd, page, PAGE_SIZE, (off_t)number * PAGE_SIZE);
+    } while (got < 0 && errno == EINTR);
+    if (got == PAGE_SIZE) return 0;
+    if (got >= 0) errno = EIO;      // Short read: the file is truncated
+    return -1;
+}
+
+int writePage(int fd, uint32_t number, const Page *page) {
+    ssize_t put;
+    do {
+        put = pwrite(fd, page, PAGE_SIZE, (off_t)number * PAGE_SIZE);
+    } while (put < 0 && errno == EINTR);
+    if (put == PAGE_SIZE) return 0;
+    if (put >= 0) errno = EIO;
+    return -1;
+}
+
+/* ---------- Buffer pool ---------- */
+
+typedef struct {
+    uint32_t number;
+    int valid;
+    int pins;                   // Pages in use are never evicted
+    int referenced;             // Second chance for CLOCK
+} Frame;
+
+typedef struct {
+    int fd;
+    Frame frames[POOL_FRAMES];
+    Page *pages;
+    int size;
+    int hand;
+    uint64_t hits, reads;
+} BufferPool;
+
+int poolInit(BufferPool *pool, int fd, int size) {
+    memset(pool, 0, sizeof(*pool));
+    pool->fd = fd;
+    pool->size = size < 1 ? 1 : size > POOL_FRAMES ? POOL_FRAMES : size;
+    pool->pages = aligned_alloc(PAGE_SIZE, (size_t)pool->size * PAGE_SIZE);
+    return pool->pages == NULL ? -1 : 0;
+}
+
+// Function to return a pinned page from the pool, reading it if needed; NULL on error
+Page *poolGet(BufferPool *pool, uint32_t number) {
+    // A pool this small is searched linearly; a large one would use a hash table
+    for (int i = 0; i < pool->size; i++) {
+        Frame *f = &pool->frames[i];
+        if (f->valid && f->number == number) {
+            f->pins++;
+            f->referenced = 1;
+            pool->hits++;
+            return &pool->pages[i];
+        }
+    }
+    // CLOCK: skip pinned frames, and give recently used ones a second chance
+    for (int step = 0; step < 2 * pool->size; step++) {
+        int i = pool->hand;
+        Frame *f = &pool->frames[i];
+        pool->hand = (pool->hand + 1) % pool->size;
+        if (f->pins > 0) continue;
+        if (f->valid && f->referenced) {
+            f->referenced = 0;
+            continue;
+        }
+        f->valid = 0;
+        if (readPage(pool->fd, number, &pool->pages[i]) != 0) return NULL;
+        pool->reads++;
+        *f = (Frame){ .number = number, .valid = 1, .pins = 1, .referenced = 1 };
+        return &pool->pages[i];
+    }
+    errno = ENOBUFS;            // Every frame is pinned
+    return NULL;
+}
+
+void poolRelease(BufferPool *pool, Page *page) {
+    pool->frames[page - pool->pages].pins--;
+}
+
+void poolFree(BufferPool *pool) {
+    free(pool->pages);
+}
+
+/* ---------- Bulk loading ---------- */
+
+typedef struct {
+    int fd;
+    Page levels[MAX_HEIGHT];    // The page being filled on each level (0 = leaves)
+    uint32_t numbers[MAX_HEIGHT];
+    int height;
+    uint32_t pageCount;         // Page numbers handed out so far
+    uint64_t keyCount;
+    uint64_t lastKey;
+} Builder;
+
+// Function to start an empty page on 'level' that will be written as page 'number'
+void builderStart(Builder *b, int level, uint32_t number) {
+    memset(&b->levels[level], 0, PAGE_SIZE);
+    b->levels[level].header.type = level == 0 ? PAGE_LEAF : PAGE_INTERNAL;
+    b->numbers[level] = number;
+}
+
+int builderAddChild(Builder *b, int level, uint64_t key, uint32_t child);
+
+// Function to write the page of 'level' and register it with the level above
+int builderFlush(Builder *b, int level, uint32_t nextLeaf) {
+    Page *page = &b->levels[level];
+    page->header.next = nextLeaf;
+    if (writePage(b->fd, b->numbers[level], page) != 0) return -1;
+    uint64_t firstKey = level == 0 ? page->leaf.records[0].key : page->internal.keys[0];
+    return builderAddChild(b, level + 1, firstKey, b->numbers[level]);
+}
+
+// Function to add a child page to 'level', writing the page first if it is full
+int builderAddChild(Builder *b, int level, uint64_t key, uint32_t child) {
+    if (level == b->height) {
+        if (level == MAX_HEIGHT) {
+            errno = EFBIG;
+            return -1;
+        }
+        b->height++;
+        builderStart(b, level, b->pageCount++);
+    }
+    Page *page = &b->levels[level];
+    if (page->header.count == INTERNAL_CAPACITY) {
+        if (builderFlush(b, level, 0) != 0) return -1;
+        builderStart(b, level, b->pageCount++);
+    }
+    page->internal.keys[page->header.count] = key;
+    page->internal.children[page->header.count] = child;
+    page->header.count++;
+    return 0;
+}
+
+int builderOpen(Builder *b, const char *path) {
+    memset(b, 0, sizeof(*b));
+    b->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (b->fd < 0) return -1;
+    b->pageCount = 2;           // Page 0 is the header, page 1 the first leaf
+    b->height = 1;
+    builderStart(b, 0, 1);
+    return 0;
+}
+
+// Function to append a record; keys must arrive in strictly increasing order
+int builderAdd(Builder *b, uint64_t key, const char *value, size_t length) {
+    if (b->keyCount > 0 && key <= b->lastKey) {
+        errno = EINVAL;
+        return -1;
+    }
+    Page *leaf = &b->levels[0];
+    if (leaf->header.count == LEAF_CAPACITY) {
+        // The next leaf's number must be known before the full one is written
+        uint32_t next = b->pageCount++;
+        if (builderFlush(b, 0, next) != 0) return -1;
+        builderStart(b, 0, next);
+    }
+    Record *r = &leaf->leaf.records[leaf->header.count++];
+    r->key = key;
+    memset(r->value, 0, VALUE_SIZE);
+    memcpy(r->value, value, length < VALUE_SIZE ? length : VALUE_SIZE);
+    b->keyCount++;
+    b->lastKey = key;
+    return 0;
+}
+
+// Function to write the partly filled pages of every level, then the header
+int builderFinish(Builder *b) {
+    int level = 0;
+    while (level < b->height - 1) {
+        if (builderFlush(b, level, 0) != 0) return -1;
+        level++;
+    }
+    // The only page on the top level is the root
+    uint32_t root = b->numbers[level];
+    if (writePage(b->fd, root, &b->levels[level]) != 0) return -1;
+    Page header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.file.magic, "BPTREE01", 8);
+    header.file.pageSize = PAGE_SIZE;
+    header.file.height = b->height;
+    header.file.rootPage = root;
+    header.file.pageCount = b->pageCount;
+    header.file.keyCount = b->keyCount;
+    // The header is written last: until then, the file is not a valid tree
+    if (fdatasync(b->fd) != 0 || writePage(b->fd, 0, &header) != 0 || fdatasync(b->fd) != 0) return -1;
+    return close(b->fd);
+}
+
+/* ---------- Lookups ---------- */
+
+typedef struct {
+    int fd;
+    Header header;
+    BufferPool pool;
+} Tree;
+
+int treeOpen(Tree *t, const char *path, int poolSize) {
+    Page first;
+    t->fd = open(path, O_RDONLY);
+    if (t->fd < 0) return -1;
+    if (readPage(t->fd, 0, &first) != 0) {
+        close(t->fd);
+        return -1;
+    }
+    t->header = first.file;
+    if (memcmp(t->header.magic, "BPTREE01", 8) != 0 || t->header.pageSize != PAGE_SIZE ||
+        t->header.height == 0 || t->header.height > MAX_HEIGHT) {
+        close(t->fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (poolInit(&t->pool, t->fd, poolSize) != 0) {
+        close(t->fd);
+        return -1;
+    }
+    return 0;
+}
+
+void treeClose(Tree *t) {
+    poolFree(&t->pool);
+    close(t->fd);
+}
+
+// Function to find the index of the last key <= 'key' in a sorted array, or -1
+int lastNotGreater(const uint64_t *keys, size_t stride, int count, uint64_t key) {
+    int low = 0, high = count;      // Answer is in [low - 1, high - 1]
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (*(const uint64_t *)((const char *)keys + middle * stride) <= key) low = middle + 1;
+        else high = middle;
+    }
+    return low - 1;
+}
+
+// Function to descend from the root to the leaf that may contain 'key'; returns it pinned
+Page *findLeaf(Tree *t, uint64_t key) {
+    uint32_t number = t->header.rootPage;
+    for (uint32_t level = t->header.height; level > 1; level--) {
+        Page *page = poolGet(&t->pool, number);
+        if (page == NULL) return NULL;
+        if (page->header.type != PAGE_INTERNAL || page->header.count == 0) {
+            poolRelease(&t->pool, page);
+            errno = EINVAL;
+            return NULL;
+        }
+        int i = lastNotGreater(page->internal.keys, sizeof(uint64_t), page->header.count, key);
+        number = page->internal.children[i < 0 ? 0 : i];
+        poolRelease(&t->pool, page);
+    }
+    Page *leaf = poolGet(&t->pool, number);
+    if (leaf != NULL && leaf->header.type != PAGE_LEAF) {
+        poolRelease(&t->pool, leaf);
+        errno = EINVAL;
+        return NULL;
+    }
+    return leaf;
+}
+
+// Function to look up 'key'; returns 1 and copies the value if found, 0 if not, -1 on error
+int treeGet(Tree *t, uint64_t key, char value[VALUE_SIZE]) {
+    Page *leaf = findLeaf(t, key);
+    if (leaf == NULL) return -1;
+    int i = lastNotGreater(&leaf->leaf.records[0].key, sizeof(Record), leaf->header.count, key);
+    int found = i >= 0 && leaf->leaf.records[i].key == key;
+    if (found) memcpy(value, leaf->leaf.records[i].value, VALUE_SIZE);
+    poolRelease(&t->pool, leaf);
+    return found;
+}
+
+// Function to call 'visit' for every record with from <= key <= to, in key order; returns the count or -1
+long treeRange(Tree *t, uint64_t from, uint64_t to, void (*visit)(const Record *)) {
+    Page *leaf = findLeaf(t, from);
+    long visited = 0;
+    while (leaf != NULL) {
+        int i = lastNotGreater(&leaf->leaf.records[0].key, sizeof(Record), leaf->header.count, from);
+        if (i < 0 || leaf->leaf.records[i].key < from) i++;
+        for (; i < leaf->header.count; i++) {
+            if (leaf->leaf.records[i].key > to) {
+                poolRelease(&t->pool, leaf);
+                return visited;
+            }
+            visit(&leaf->leaf.records[i]);
+            visited++;
+        }
+        uint32_t next = leaf->header.next;
+        poolRelease(&t->pool, leaf);
+        if (next == 0) return visited;
+        leaf = poolGet(&t->pool, next);
+        if (leaf != NULL && leaf->header.type != PAGE_LEAF) {
+            poolRelease(&t->pool, leaf);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/* ---------- Commands ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to produce the value stored for a generated key
+int valueFor(uint64_t key, char *value, size_t size) {
+    return snprintf(value, size, "item-%llx", (unsigned long long)(key * 0x9E3779B97F4A7C15ULL >> 20));
+}
+
+int generateInput(const char *path, long n) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        perror(path);
+        return 1;
+    }
+    uint64_t x = 88172645463325252ULL, key = 0;
+    char value[32];
+    for (long i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        key += 1 + x % 16;              // Increasing, with gaps
+        valueFor(key, value, sizeof(value));
+        fprintf(out, "%llu %s\n", (unsigned long long)key, value);
+    }
+    if (fclose(out) != 0) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
+
+int buildTree(const char *path, const char *inputPath) {
+    FILE *in = fopen(inputPath, "r");
+    if (in == NULL) {
+        perror(inputPath);
+        return 1;
+    }
+    Builder *b = malloc(sizeof(Builder));
+    if (b == NULL) {
+        printf("Out of memory.\n");
+        fclose(in);
+        return 1;
+    }
+    if (builderOpen(b, path) != 0) {
+        perror(path);
+        free(b);
+        fclose(in);
+        return 1;
+    }
+    double start = nowSeconds();
+    char *line = NULL;
+    size_t capacity = 0;
+    long lineNumber = 0, truncated = 0;
+    int status = 0;
+    while (status == 0 && getline(&line, &capacity, in) > 0) {
+        lineNumber++;
+        char *end;
+        errno = 0;
+        uint64_t key = strtoull(line, &end, 10);
+        if (end == line || errno != 0) {
+            fprintf(stderr, "%s:%ld: expected KEY VALUE\n", inputPath, lineNumber);
+            status = 1;
+            break;
+        }
+        while (*end == ' ' || *end == '\t') end++;
+        size_t valueLength = strcspn(end, "\r\n");
+        truncated += valueLength > VALUE_SIZE;
+        if (builderAdd(b, key, end, valueLength) != 0) {
+            if (errno == EINVAL) fprintf(stderr, "%s:%ld: keys must be sorted and unique\n", inputPath, lineNumber);
+            else perror(path);
+            status = 1;
+        }
+    }
+    free(line);
+    fclose(in);
+    if (status != 0) {
+        // The header was never written, so the file is not mistaken for a tree
+        close(b->fd);
+    } else if (builderFinish(b) != 0) {
+        perror(path);
+        status = 1;
+    } else {
+        printf("Loaded %llu records in %.2f s: %u pages (%.1f MB), height %d\n",
+               (unsigned long long)b->keyCount, nowSeconds() - start, b->pageCount,
+               b->pageCount * (double)PAGE_SIZE / 1e6, b->height);
+        printf("Leaves hold %zu records, internal pages %zu children\n", LEAF_CAPACITY, INTERNAL_CAPACITY);
+        if (truncated > 0) printf("%ld values were cut to %d bytes\n", truncated, VALUE_SIZE);
+    }
+    free(b);
+    return status;
+}
+
+void printRecord(const Record *r) {
+    printf("%-20llu %.*s\n", (unsigned long long)r->key, (int)strnlen(r->value, VALUE_SIZE), r->value);
+}
+
+// Function to find a key by reading the text input from the start, as without an index
+int linearFind(const char *inputPath, uint64_t key) {
+    FILE *in = fopen(inputPath, "r");
+    char line[256];
+    int found = 0;
+    while (in != NULL && fgets(line, sizeof(line), in) != NULL) {
+        if (strtoull(line, NULL, 10) == key) {
+            found = 1;
+            break;
+        }
+    }
+    if (in != NULL) fclose(in);
+    return found;
+}
+
+int benchmark(const char *path, const char *inputPath, long lookups) {
+    // Read the keys of the input, to look up keys that exist (and some that do not)
+    FILE *in = fopen(inputPath, "r");
+    if (in == NULL) {
+        perror(inputPath);
+        return 1;
+    }
+    size_t count = 0, capacity = 1 << 20;
+    uint64_t *keys = malloc(capacity * sizeof(uint64_t));
+    char line[256];
+    while (keys != NULL && fgets(line, sizeof(line), in) != NULL) {
+        if (count == capacity) {
+            capacity *= 2;
+            uint64_t *grown = realloc(keys, capacity * sizeof(uint64_t));
+            if (grown == NULL) {
+                free(keys);
+                keys = NULL;
+                break;
+            }
+            keys = grown;
+        }
+        keys[count++] = strtoull(line, NULL, 10);
+    }
+    fclose(in);
+    if (keys == NULL || count == 0) {
+        printf(keys == NULL ? "Out of memory.\n" : "The input is empty.\n");
+        return 1;
+    }
+
+    Tree t;
+    if (treeOpen(&t, path, POOL_FRAMES) != 0) {
+        perror(path);
+        return 1;
+    }
+    printf("%llu keys, height %u, %u pages, pool of %d pages\n", (unsigned long long)t.header.keyCount,
+           t.header.height, t.header.pageCount, t.pool.size);
+    // Drop the index from the page cache, so the first pass really reads from disk
+    posix_fadvise(t.fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    for (int pass = 1; pass <= 2; pass++) {
+        uint64_t x = 88172645463325252ULL, reads = t.pool.reads, hits = t.pool.hits;
+        long found = 0, wrong = 0;
+        double start = nowSeconds();
+        for (long i = 0; i < lookups; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            uint64_t key = keys[x % count] + (i % 8 == 7);  // Every 8th key is (usually) missing
+            char value[VALUE_SIZE], expected[32];
+            int result = treeGet(&t, key, value);
+            if (result < 0) {
+                perror("lookup");
+                return 1;
+            }
+            if (result == 1) {
+                found++;
+                int n = valueFor(key, expected, sizeof(expected));
+                wrong += memcmp(value, expected, n) != 0;
+            }
+        }
+        double seconds = nowSeconds() - start;
+        printf("%s pass: %ld lookups, %ld found, %ld wrong values, %.2f us each, "
+               "%.2f page reads each (%.0f%% pool hits)\n",
+               pass == 1 ? "Cold" : "Warm", lookups, found, wrong, seconds / lookups * 1e6,
+               (double)(t.pool.reads - reads) / lookups,
+               100.0 * (t.pool.hits - hits) / (t.pool.hits - hits + t.pool.reads - reads));
+    }
+
+    // Without an index: read the text file until the key turns up
+    int scans = 5;
+    double start = nowSeconds();
+    uint64_t x = 1;
+    for (int i = 0; i < scans; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        linearFind(inputPath, keys[x % count]);
+    }
+    printf("Linear scan of %s: %.1f ms per lookup (average of %d)\n", inputPath,
+           (nowSeconds() - start) / scans * 1e3, scans);
+    treeClose(&t);
+    free(keys);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s FILE generate N | build INPUT | get KEY... | range FROM TO | bench INPUT [N]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1], *command = argv[2];
+    if (strcmp(command, "generate") == 0 && argc == 4) return generateInput(path, atol(argv[3]));
+    if (strcmp(command, "build") == 0 && argc == 4) return buildTree(path, argv[3]);
+    if (strcmp(command, "bench") == 0 && (argc == 4 || argc == 5))
+        return benchmark(path, argv[3], argc == 5 ? atol(argv[4]) : 100000);
+
+    Tree t;
+    if (treeOpen(&t, path, POOL_FRAMES) != 0) {
+        perror(path);
+        return 1;
+    }
+    int status = 0;
+    if (strcmp(command, "get") == 0) {
+        for (int i = 3; i < argc; i++) {
+            char value[VALUE_SIZE];
+            uint64_t key = strtoull(argv[i], NULL, 10);
+            int result = treeGet(&t, key, value);
+            if (result == 1) {
+                printf("%-20llu %.*s\n", (unsigned long long)key, (int)strnlen(value, VALUE_SIZE), value);
+            } else {
+                printf("%-20llu %s\n", (unsigned long long)key, result == 0 ? "(not found)" : strerror(errno));
+                status = 1;
+            }
+        }
+    } else if (strcmp(command, "range") == 0 && argc == 5) {
+        long n = treeRange(&t, strtoull(argv[3], NULL, 10), strtoull(argv[4], NULL, 10), printRecord);
+        if (n < 0) {
+            perror("range");
+            status = 1;
+        } else {
+            printf("%ld records, %llu page reads\n", n, (unsigned long long)t.pool.reads);
+        }
+    } else {
+        fprintf(stderr, "Unknown command: %s\n", command);
+        status = 2;
+    }
+    treeClose(&t);
+    return status;
+}
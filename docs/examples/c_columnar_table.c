@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/*
+    COLUMNAR (STRUCTURE-OF-ARRAYS) RECORD TABLE
+
+    Array of structs (AoS):
+    - struct Order orders[n]; keeps each record's fields together. A query
+      that reads only price and quantity still pulls whole 120-byte records
+      through the cache, so most of every cache line is wasted.
+
+    Structure of arrays (SoA):
+    - Every field is its own contiguous array (a column). Reading one field
+      of all rows reads only that column, 8 or 4 bytes per row, and simple
+      loops over a column can be vectorized by the compiler.
+
+    This table:
+    - A schema of named, typed columns (int32, int64, double).
+    - tableAppendRow() grows every column together (capacity doubling).
+    - Typed accessors (tableInt32, tableInt64, tableDouble) return the raw
+      column array after checking the column's type.
+    - Filters write a selection vector: the list of row numbers that pass.
+      Filters can be chained by passing one filter's selection to the
+      next, and aggregates can run over all rows or over a selection.
+*/
+
+typedef enum { COL_INT32, COL_INT64, COL_DOUBLE } ColumnType;
+
+typedef struct {
+    const char *name;
+    ColumnType type;
+    void *data;
+} Column;
+
+#define MAX_COLUMNS 16
+
+typedef struct {
+    Column columns[MAX_COLUMNS];
+    int columnCount;
+    size_t rows;
+    size_t capacity;
+} Table;
+
+typedef enum { CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_EQ, CMP_NE } Comparison;
+
+typedef struct {
+    double sum;
+    double min;
+    double max;
+    size_t count;
+} Aggregate;
+
+size_t typeSize(ColumnType type) {
+    return type == COL_INT32 ? sizeof(int32_t) : type == COL_INT64 ? sizeof(int64_t) : sizeof(double);
+}
+
+void tableInit(Table *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+// Function to add a column to an empty table; returns the column number or -1
+int tableAddColumn(Table *t, const char *name, ColumnType type) {
+    if (t->columnCount == MAX_COLUMNS || t->rows > 0) return -1;
+    t->columns[t->columnCount] = (Column){name, type, NULL};
+    return t->columnCount++;
+}
+
+// Function to append one row (all fields 0); returns its row number, or -1 if out of memory
+long tableAppendRow(Table *t) {
+    if (t->rows == t->capacity) {
+        size_t capacity = t->capacity ? t->capacity * 2 : 1024;
+        for (int c = 0; c < t->columnCount; c++) {
+            void *data = realloc(t->columns[c].data, capacity * typeSize(t->columns[c].type));
+            if (data == NULL) return -1;
+            t->columns[c].data = data;
+        }
+        t->capacity = capacity;
+    }
+    for (int c = 0; c < t->columnCount; c++) {
+        size_t size = typeSize(t->columns[c].type);
+        memset((char *)t->columns[c].data + t->rows * size, 0, size);
+    }
+    return (long)t->rows++;
+}
+
+void tableFree(Table *t) {
+    for (int c = 0; c < t->columnCount; c++) free(t->columns[c].data);
+    tableInit(t);
+}
+
+// Typed accessors: the column array, or NULL if the column has another type
+static inline Column *typedColumn(Table *t, int c, ColumnType type) {
+    if (c < 0 || c >= t->columnCount || t->columns[c].type != type) return NULL;
+    return &t->columns[c];
+}
+
+int32_t *tableInt32(Table *t, int c) {
+    Column *col = typedColumn(t, c, COL_INT32);
+    return col ? col->data : NULL;
+}
+
+int64_t *tableInt64(Table *t, int c) {
+    Column *col = typedColumn(t, c, COL_INT64);
+    return col ? col->data : NULL;
+}
+
+double *tableDouble(Table *t, int c) {
+    Column *col = typedColumn(t, c, COL_DOUBLE);
+    return col ? col->data : NULL;
+}
+
+/* ---------- Filters ---------- */
+
+// Each filter reads rows from 'in' (or all rows when in == NULL) and writes passing row numbers to out
+// out may be the same array as in; returns the number of passing rows
+
+#define DEFINE_FILTER(name, type)                                                              \
+    size_t name(const type *col, size_t rows, Comparison cmp, type value,                    \
+                const uint32_t *in, size_t inCount, uint32_t *out) {                         \
+        size_t n = in ? inCount : rows, k = 0;                                               \
+        for (size_t j = 0; j < n; j++) {                                                     \
+            uint32_t row = in ? in[j] : (uint32_t)j;                                         \
+            type x = col[row];                                                               \
+            int pass = cmp == CMP_LT ? x < value : cmp == CMP_LE ? x <= value :              \
+                       cmp == CMP_GT ? x > value : cmp == CMP_GE ? x >= value :              \
+                       cmp == CMP_EQ ? x == value : x != value;                              \
+            out[k] = row;   /* Always written; only kept if the row passes (no branch) */    \
+            k += pass;                                                                       \
+        }                                                                                    \
+        return k;                                                                            \
+    }
+
+DEFINE_FILTER(filterInt32, int32_t)
+DEFINE_FILTER(filterInt64, int64_t)
+DEFINE_FILTER(filterDouble, double)
+
+// General filter: any condition over the whole row, written as a function
+typedef int (*RowPredicate)(Table *t, size_t row, void *context);
+
+size_t filterRows(Table *t, RowPredicate predicate, void *context, const uint32_t *in, size_t inCount,
+                  uint32_t *out) {
+    size_t n = in ? inCount : t->rows, k = 0;
+    for (size_t j = 0; j < n; j++) {
+        uint32_t row = in ? in[j] : (uint32_t)j;
+        if (predicate(t, row, context)) out[k++] = row;
+    }
+    return k;
+}
+
+/* ---------- Aggregates ---------- */
+
+// Function to sum/min/max a double column over all rows, with four independent accumulators
+Aggregate aggregateDouble(const double *col, size_t rows) {
+    double sum[4] = {0, 0, 0, 0};
+    double lo[4], hi[4];
+    Aggregate a = {0, 0, 0, rows};
+    if (rows == 0) return a;
+    for (int l = 0; l < 4; l++) lo[l] = hi[l] = col[0];
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        for (int l = 0; l < 4; l++) {
+            double x = col[i + l];
+            sum[l] += x;
+            lo[l] = x < lo[l] ? x : lo[l];
+            hi[l] = x > hi[l] ? x : hi[l];
+        }
+    }
+    for (; i < rows; i++) {
+        sum[0] += col[i];
+        lo[0] = col[i] < lo[0] ? col[i] : lo[0];
+        hi[0] = col[i] > hi[0] ? col[i] : hi[0];
+    }
+    a.sum = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    a.min = lo[0];
+    a.max = hi[0];
+    for (int l = 1; l < 4; l++) {
+        if (lo[l] < a.min) a.min = lo[l];
+        if (hi[l] > a.max) a.max = hi[l];
+    }
+    return a;
+}
+
+// Function to aggregate a double column over the rows of a selection vector
+Aggregate aggregateDoubleSelected(const double *col, const uint32_t *sel, size_t count) {
+    Aggregate a = {0, 0, 0, count};
+    double sum[4] = {0, 0, 0, 0};
+    if (count == 0) return a;
+    a.min = a.max = col[sel[0]];
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        for (int l = 0; l < 4; l++) sum[l] += col[sel[j + l]];
+    }
+    for (; j < count; j++) sum[0] += col[sel[j]];
+    for (j = 0; j < count; j++) {
+        double x = col[sel[j]];
+        if (x < a.min) a.min = x;
+        if (x > a.max) a.max = x;
+    }
+    a.sum = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    return a;
+}
+
+// Function to sum an int32 column (exact, in 64 bits)
+int64_t sumInt32(const int32_t *col, size_t rows) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < rows; i++) sum += col[i];    // Simple enough for the compiler to vectorize
+    return sum;
+}
+
+/* ---------- Demo and benchmark ---------- */
+
+// The same records as one wide struct (array-of-structs layout)
+typedef struct {
+    int64_t id;
+    int64_t timestamp;
+    int32_t customer;
+    int32_t quantity;
+    int32_t region;
+    int32_t status;
+    double price;
+    double discount;
+    char notes[72];
+} Order;
+
+enum { ID, TIMESTAMP, CUSTOMER, QUANTITY, REGION, STATUS, PRICE, DISCOUNT };
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int bigOrderInRegion(Table *t, size_t row, void *context) {
+    return tableInt32(t, REGION)[row] == *(int32_t *)context && tableInt32(t, QUANTITY)[row] > 90;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+    Table t;
+    tableInit(&t);
+    tableAddColumn(&t, "id", COL_INT64);
+    tableAddColumn(&t, "timestamp", COL_INT64);
+    tableAddColumn(&t, "customer", COL_INT32);
+    tableAddColumn(&t, "quantity", COL_INT32);
+    tableAddColumn(&t, "region", COL_INT32);
+    tableAddColumn(&t, "status", COL_INT32);
+    tableAddColumn(&t, "price", COL_DOUBLE);
+    tableAddColumn(&t, "discount", COL_DOUBLE);
+
+    Order *orders = malloc(n * sizeof(Order));
+    uint32_t *sel = malloc(n * sizeof(uint32_t));
+    if (orders == NULL || sel == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < n; i++) {
+        long row = tableAppendRow(&t);
+        if (row < 0) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        Order o = {0};
+        o.id = (int64_t)i;
+        o.timestamp = 1700000000 + (int64_t)i;
+        o.customer = (int32_t)(nextRandom(&state) % 100000);
+        o.quantity = (int32_t)(nextRandom(&state) % 100) + 1;
+        o.region = (int32_t)(nextRandom(&state) % 8);
+        o.status = (int32_t)(nextRandom(&state) % 4);
+        o.price = (double)(nextRandom(&state) % 100000) / 100;
+        o.discount = (double)(nextRandom(&state) % 30) / 100;
+        orders[i] = o;
+        tableInt64(&t, ID)[row] = o.id;
+        tableInt64(&t, TIMESTAMP)[row] = o.timestamp;
+        tableInt32(&t, CUSTOMER)[row] = o.customer;
+        tableInt32(&t, QUANTITY)[row] = o.quantity;
+        tableInt32(&t, REGION)[row] = o.region;
+        tableInt32(&t, STATUS)[row] = o.status;
+        tableDouble(&t, PRICE)[row] = o.price;
+        tableDouble(&t, DISCOUNT)[row] = o.discount;
+    }
+    printf("%zu orders: %zu bytes per row as structs, %zu bytes per row as columns\n", n, sizeof(Order),
+           (size_t)(2 * 8 + 4 * 4 + 2 * 8));
+    printf("Typed accessor check: tableDouble(\"quantity\") = %s\n\n",
+           tableDouble(&t, QUANTITY) == NULL ? "NULL (wrong type)" : "column");
+
+    // Query 1: total, min and max price over all rows
+    double start = nowSeconds();
+    double aosSum = 0, aosMin = 1e300, aosMax = -1e300;
+    for (size_t i = 0; i < n; i++) {
+        aosSum += orders[i].price;
+        if (orders[i].price < aosMin) aosMin = orders[i].price;
+        if (orders[i].price > aosMax) aosMax = orders[i].price;
+    }
+    double aosTime = nowSeconds() - start;
+    start = nowSeconds();
+    Aggregate all = aggregateDouble(tableDouble(&t, PRICE), t.rows);
+    double soaTime = nowSeconds() - start;
+    printf("sum/min/max(price):  structs %7.2f ms | columns %7.2f ms | sum %.2f, min %.2f, max %.2f\n",
+           aosTime * 1e3, soaTime * 1e3, all.sum, all.min, all.max);
+
+    // Query 2: sum(price) WHERE region = 3 AND quantity > 90 AND status = 1
+    start = nowSeconds();
+    double aosFiltered = 0;
+    size_t aosCount = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (orders[i].region == 3 && orders[i].quantity > 90 && orders[i].status == 1) {
+            aosFiltered += orders[i].price;
+            aosCount++;
+        }
+    }
+    aosTime = nowSeconds() - start;
+    start = nowSeconds();
+    size_t count = filterInt32(tableInt32(&t, REGION), t.rows, CMP_EQ, 3, NULL, 0, sel);
+    count = filterInt32(tableInt32(&t, QUANTITY), t.rows, CMP_GT, 90, sel, count, sel);
+    count = filterInt32(tableInt32(&t, STATUS), t.rows, CMP_EQ, 1, sel, count, sel);
+    Aggregate some = aggregateDoubleSelected(tableDouble(&t, PRICE), sel, count);
+    soaTime = nowSeconds() - start;
+    printf("filtered sum(price): structs %7.2f ms | columns %7.2f ms | %zu rows, sum %.2f\n",
+           aosTime * 1e3, soaTime * 1e3, some.count, some.sum);
+
+    // The same first two conditions as a general predicate
+    int32_t region = 3;
+    start = nowSeconds();
+    size_t predicateCount = filterRows(&t, bigOrderInRegion, &region, NULL, 0, sel);
+    double predicateTime = nowSeconds() - start;
+    printf("predicate filter:    %7.2f ms for %zu rows (region 3, quantity > 90)\n", predicateTime * 1e3,
+           predicateCount);
+
+    start = nowSeconds();
+    int64_t quantity = sumInt32(tableInt32(&t, QUANTITY), t.rows);
+    printf("sum(quantity):       %lld in %.2f ms\n", (long long)quantity, (nowSeconds() - start) * 1e3);
+
+    // Summation order differs between the two layouts, so compare with a tolerance
+    int ok = aosCount == some.count && aosMin == all.min && aosMax == all.max &&
+             (aosSum - all.sum) * (aosSum - all.sum) < 1e-6 * aosSum * aosSum &&
+             (aosFiltered - some.sum) * (aosFiltered - some.sum) <= 1e-6 * aosFiltered * aosFiltered;
+    printf("Results match: %s\n", ok ? "yes" : "no");
+
+    free(orders);
+    free(sel);
+    tableFree(&t);
+    return 0;
+}
@@ -0,0 +1,732 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+
+/*
+    BYTECODE EXPRESSION INTERPRETER
+
+    Pipeline:
+    - Parse: a recursive descent parser turns text such as
+      "x * x + 3 * y - sqrt(abs(z)) / 2" into a tree of Nodes.
+    - Fold: subtrees that only contain numbers are computed once,
+      at compile time ("2 * 3 + x" becomes "6 + x").
+    - Compile: the tree is flattened into bytecode for a stack machine.
+      Every instruction is one opcode byte, plus one operand byte for
+      constants and variables.
+    - Run: the bytecode is evaluated once per record.
+
+    Why bytecode:
+    - A tree-walking interpreter follows a pointer and makes a recursive
+      call for every node, on every record.
+    - Bytecode is one small, contiguous array. The interpreter is a loop
+      that reads an opcode and jumps to the code for it (dispatch).
+
+    Dispatch styles:
+    - switch: one shared indirect jump at the top of the loop. The CPU
+      predicts it poorly, because every opcode goes through the same jump.
+    - computed goto (GCC/Clang extension): &&label takes the address of a
+      label, and goto *address jumps to it. Each handler ends with its own
+      jump to the next handler ("threaded code"), so each one gets its own
+      branch prediction history.
+    - batch: each instruction is run over a block of 256 records before
+      moving to the next one, so dispatch is paid once per block.
+
+    Other tricks:
+    - The top of the stack is kept in a local variable (acc), which the
+      compiler keeps in a register.
+    - Superinstructions: "x + 3" compiles to VAR x, ADDC 3 instead of
+      VAR x, CONST 3, ADD.
+    - The maximum stack depth is computed at compile time, so the
+      interpreter never has to check for stack overflow.
+*/
+
+#define MAX_VARS 8
+#define MAX_CONSTS 256
+#define MAX_CODE 1024
+#define STACK_SIZE 64
+#define BLOCK 256
+
+// Every opcode with the number of operand bytes it takes
+#define OPCODES(X) \
+    X(CONST, 1) X(VAR, 1) \
+    X(ADD, 0) X(SUB, 0) X(MUL, 0) X(DIV, 0) X(POW, 0) \
+    X(ADDC, 1) X(SUBC, 1) X(MULC, 1) X(DIVC, 1) \
+    X(ADDV, 1) X(SUBV, 1) X(MULV, 1) X(DIVV, 1) \
+    X(NEG, 0) X(SQRT, 0) X(ABS, 0) X(MIN, 0) X(MAX, 0) \
+    X(END, 0)
+
+enum {
+#define X(name, args) OP_##name,
+    OPCODES(X)
+#undef X
+    OP_COUNT
+};
+
+const char *opNames[] = {
+#define X(name, args) #name,
+    OPCODES(X)
+#undef X
+};
+
+const int opArgs[] = {
+#define X(name, args) args,
+    OPCODES(X)
+#undef X
+};
+
+typedef enum {
+    N_NUM, N_VAR, N_NEG, N_ADD, N_SUB, N_MUL, N_DIV, N_POW, N_SQRT, N_ABS, N_MIN, N_MAX
+} NodeKind;
+
+typedef struct Node {
+    NodeKind kind;
+    double value;          // N_NUM
+    int var;               // N_VAR: variable slot
+    struct Node *left;
+    struct Node *right;
+} Node;
+
+typedef struct {
+    const char *text;
+    const char *pos;
+    char error[128];
+    char varNames[MAX_VARS][16];
+    int varCount;
+} Parser;
+
+typedef struct {
+    uint8_t code[MAX_CODE];
+    int length;
+    double consts[MAX_CONSTS];
+    int constCount;
+    int depth;             // Current stack depth while compiling
+    int maxDepth;
+    int varCount;
+    char error[128];
+} Program;
+
+/* ---------- Parsing ---------- */
+
+Node *newNode(NodeKind kind, Node *left, Node *right) {
+    Node *node = calloc(1, sizeof(Node));
+    if (node == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    node->kind = kind;
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+void freeTree(Node *node) {
+    if (node == NULL) return;
+    freeTree(node->left);
+    freeTree(node->right);
+    free(node);
+}
+
+void skipSpaces(Parser *p) {
+    while (isspace((unsigned char)*p->pos)) p->pos++;
+}
+
+// Function to record the first error and its column
+Node *parseError(Parser *p, const char *message) {
+    if (p->error[0] == '\0') {
+        snprintf(p->error, sizeof(p->error), "%s at column %d", message, (int)(p->pos - p->text) + 1);
+    }
+    return NULL;
+}
+
+Node *parseExpr(Parser *p);
+Node *parseUnary(Parser *p);
+
+// Function to look up a variable name, adding it if it is new
+int variableSlot(Parser *p, const char *name, size_t length) {
+    for (int i = 0; i < p->varCount; i++) {
+        if (strlen(p->varNames[i]) == length && strncmp(p->varNames[i], name, length) == 0) return i;
+    }
+    if (p->varCount == MAX_VARS || length >= sizeof(p->varNames[0])) return -1;
+    memcpy(p->varNames[p->varCount], name, length);
+    p->varNames[p->varCount][length] = '\0';
+    return p->varCount++;
+}
+
+// primary := number | name | name '(' args ')' | '(' expr ')'
+Node *parsePrimary(Parser *p) {
+    skipSpaces(p);
+    if (isdigit((unsigned char)*p->pos) || *p->pos == '.') {
+        char *end;
+        Node *node = newNode(N_NUM, NULL, NULL);
+        node->value = strtod(p->pos, &end);
+        p->pos = end;
+        return node;
+    }
+    if (*p->pos == '(') {
+        p->pos++;
+        Node *node = parseExpr(p);
+        skipSpaces(p);
+        if (node == NULL || *p->pos != ')') {
+            freeTree(node);
+            return parseError(p, "expected ')'");
+        }
+        p->pos++;
+        return node;
+    }
+    if (!isalpha((unsigned char)*p->pos) && *p->pos != '_') return parseError(p, "expected a number or a name");
+
+    const char *name = p->pos;
+    while (isalnum((unsigned char)*p->pos) || *p->pos == '_') p->pos++;
+    size_t length = p->pos - name;
+    skipSpaces(p);
+    if (*p->pos != '(') {
+        int slot = variableSlot(p, name, length);
+        if (slot < 0) return parseError(p, "too many variables or name too long");
+        Node *node = newNode(N_VAR, NULL, NULL);
+        node->var = slot;
+        return node;
+    }
+
+    // Function call
+    static const struct { const char *name; NodeKind kind; int args; } functions[] = {
+        {"sqrt", N_SQRT, 1}, {"abs", N_ABS, 1}, {"min", N_MIN, 2}, {"max", N_MAX, 2}, {"pow", N_POW, 2},
+    };
+    int f = -1;
+    for (int i = 0; i < (int)(sizeof(functions) / sizeof(functions[0])); i++) {
+        if (strlen(functions[i].name) == length && strncmp(functions[i].name, name, length) == 0) f = i;
+    }
+    if (f < 0) return parseError(p, "unknown function");
+    p->pos++;
+    Node *left = parseExpr(p), *right = NULL;
+    skipSpaces(p);
+    if (left != NULL && functions[f].args == 2) {
+        if (*p->pos != ',') {
+            freeTree(left);
+            return parseError(p, "expected ','");
+        }
+        p->pos++;
+        right = parseExpr(p);
+        skipSpaces(p);
+    }
+    if (left == NULL || (functions[f].args == 2 && right == NULL) || *p->pos != ')') {
+        freeTree(left);
+        freeTree(right);
+        return parseError(p, "expected ')'");
+    }
+    p->pos++;
+    return newNode(functions[f].kind, left, right);
+}
+
+// power := primary ('^' unary)?      (right associative: 2^3^2 = 2^9)
+Node *parsePower(Parser *p) {
+    Node *left = parsePrimary(p);
+    skipSpaces(p);
+    if (left == NULL || *p->pos != '^') return left;
+    p->pos++;
+    Node *right = parseUnary(p);
+    if (right == NULL) {
+        freeTree(left);
+        return NULL;
+    }
+    return newNode(N_POW, left, right);
+}
+
+// unary := '-' unary | power         (so -2^2 = -(2^2))
+Node *parseUnary(Parser *p) {
+    skipSpaces(p);
+    if (*p->pos == '-') {
+        p->pos++;
+        Node *operand = parseUnary(p);
+        return operand == NULL ? NULL : newNode(N_NEG, operand, NULL);
+    }
+    return parsePower(p);
+}
+
+// term := unary (('*' | '/') unary)*
+Node *parseTerm(Parser *p) {
+    Node *left = parseUnary(p);
+    for (;;) {
+        skipSpaces(p);
+        if (left == NULL || (*p->pos != '*' && *p->pos != '/')) return left;
+        NodeKind kind = *p->pos++ == '*' ? N_MUL : N_DIV;
+        Node *right = parseUnary(p);
+        if (right == NULL) {
+            freeTree(left);
+            return NULL;
+        }
+        left = newNode(kind, left, right);
+    }
+}
+
+// expr := term (('+' | '-') term)*
+Node *parseExpr(Parser *p) {
+    Node *left = parseTerm(p);
+    for (;;) {
+        skipSpaces(p);
+        if (left == NULL || (*p->pos != '+' && *p->pos != '-')) return left;
+        NodeKind kind = *p->pos++ == '+' ? N_ADD : N_SUB;
+        Node *right = parseTerm(p);
+        if (right == NULL) {
+            freeTree(left);
+            return NULL;
+        }
+        left = newNode(kind, left, right);
+    }
+}
+
+// Function to parse a whole formula; returns NULL and sets p->error on failure
+Node *parseFormula(Parser *p, const char *text) {
+    memset(p, 0, sizeof(*p));
+    p->text = p->pos = text;
+    Node *root = parseExpr(p);
+    skipSpaces(p);
+    if (root != NULL && *p->pos != '\0') {
+        freeTree(root);
+        return parseError(p, "unexpected character");
+    }
+    return root;
+}
+
+/* ---------- Tree-walking evaluation (the baseline) ---------- */
+
+double applyBinary(NodeKind kind, double a, double b) {
+    switch (kind) {
+        case N_ADD: return a + b;
+        case N_SUB: return a - b;
+        case N_MUL: return a * b;
+        case N_DIV: return a / b;
+        case N_POW: return pow(a, b);
+        case N_MIN: return fmin(a, b);
+        case N_MAX: return fmax(a, b);
+        default:    return 0;
+    }
+}
+
+double evalTree(const Node *node, const double *vars) {
+    switch (node->kind) {
+        case N_NUM:  return node->value;
+        case N_VAR:  return vars[node->var];
+        case N_NEG:  return -evalTree(node->left, vars);
+        case N_SQRT: return sqrt(evalTree(node->left, vars));
+        case N_ABS:  return fabs(evalTree(node->left, vars));
+        default:     return applyBinary(node->kind, evalTree(node->left, vars), evalTree(node->right, vars));
+    }
+}
+
+// Function to replace every subtree without variables by its value
+void foldConstants(Node *node) {
+    if (node == NULL || node->kind == N_NUM || node->kind == N_VAR) return;
+    foldConstants(node->left);
+    foldConstants(node->right);
+    if (node->left->kind == N_NUM && (node->right == NULL || node->right->kind == N_NUM)) {
+        node->value = evalTree(node, NULL);
+        freeTree(node->left);
+        freeTree(node->right);
+        node->left = node->right = NULL;
+        node->kind = N_NUM;
+    }
+}
+
+/* ---------- Compiling to bytecode ---------- */
+
+void emit(Program *prog, int op, int arg) {
+    if (prog->length + 2 > MAX_CODE) {
+        snprintf(prog->error, sizeof(prog->error), "formula too long");
+        return;
+    }
+    prog->code[prog->length++] = (uint8_t)op;
+    if (opArgs[op]) prog->code[prog->length++] = (uint8_t)arg;
+}
+
+int addConstant(Program *prog, double value) {
+    for (int i = 0; i < prog->constCount; i++) {
+        if (memcmp(&prog->consts[i], &value, sizeof(double)) == 0) return i;
+    }
+    if (prog->constCount == MAX_CONSTS) {
+        snprintf(prog->error, sizeof(prog->error), "too many constants");
+        return 0;
+    }
+    prog->consts[prog->constCount] = value;
+    return prog->constCount++;
+}
+
+void push(Program *prog) {
+    if (++prog->depth > prog->maxDepth) prog->maxDepth = prog->depth;
+}
+
+int isLeaf(const Node *node) {
+    return node->kind == N_NUM || node->kind == N_VAR;
+}
+
+void compileNode(Program *prog, const Node *node) {
+    static const int binaryOps[] = {
+        [N_ADD] = OP_ADD, [N_SUB] = OP_SUB, [N_MUL] = OP_MUL, [N_DIV] = OP_DIV,
+        [N_POW] = OP_POW, [N_MIN] = OP_MIN, [N_MAX] = OP_MAX,
+    };
+    switch (node->kind) {
+        case N_NUM:
+            emit(prog, OP_CONST, addConstant(prog, node->value));
+            push(prog);
+            return;
+        case N_VAR:
+            emit(prog, OP_VAR, node->var);
+            push(prog);
+            return;
+        case N_NEG:
+        case N_SQRT:
+        case N_ABS:
+            compileNode(prog, node->left);
+            emit(prog, node->kind == N_NEG ? OP_NEG : node->kind == N_SQRT ? OP_SQRT : OP_ABS, 0);
+            return;
+        default:
+            break;
+    }
+
+    const Node *left = node->left, *right = node->right;
+    int arithmetic = node->kind == N_ADD || node->kind == N_SUB || node->kind == N_MUL || node->kind == N_DIV;
+    // a + b == b + a exactly in floating point, so a leaf on the left can be moved right
+    if ((node->kind == N_ADD || node->kind == N_MUL) && isLeaf(left) && !isLeaf(right)) {
+        const Node *t = left;
+        left = right;
+        right = t;
+    }
+    compileNode(prog, left);
+    if (arithmetic && isLeaf(right)) {
+        // Superinstruction: the right operand is encoded in the instruction itself
+        int offset = node->kind - N_ADD;
+        if (right->kind == N_NUM) emit(prog, OP_ADDC + offset, addConstant(prog, right->value));
+        else emit(prog, OP_ADDV + offset, right->var);
+        return;
+    }
+    compileNode(prog, right);
+    emit(prog, binaryOps[node->kind], 0);
+    prog->depth--;
+}
+
+// Function to compile a parsed tree; returns 0 on success
+int compileProgram(Program *prog, Node *root, int varCount) {
+    memset(prog, 0, sizeof(*prog));
+    prog->varCount = varCount;
+    foldConstants(root);
+    compileNode(prog, root);
+    emit(prog, OP_END, 0);
+    // Every push stores the old acc, even the empty one before the first value, so the array needs maxDepth slots
+    if (prog->error[0] == '\0' && prog->maxDepth > STACK_SIZE) {
+        snprintf(prog->error, sizeof(prog->error), "formula nested too deeply");
+    }
+    return prog->error[0] != '\0';
+}
+
+// Function to print the instruction at pc; returns the position of the next one
+int printInstruction(const Program *prog, const Parser *names, int pc) {
+    int op = prog->code[pc++];
+    printf("%s", opNames[op]);
+    if (opArgs[op]) {
+        int arg = prog->code[pc++];
+        if (op == OP_VAR || (op >= OP_ADDV && op <= OP_DIVV)) printf(" %s", names->varNames[arg]);
+        else printf(" %g", prog->consts[arg]);
+    }
+    return pc;
+}
+
+void disassemble(const Program *prog, const Parser *names) {
+    for (int pc = 0; pc < prog->length;) {
+        printf("  %3d  ", pc);
+        pc = printInstruction(prog, names, pc);
+        printf("\n");
+    }
+}
+
+/* ---------- Running the bytecode ---------- */
+
+// switch dispatch: every opcode goes through the same indirect jump
+double runSwitch(const Program *prog, const double *vars) {
+    double stack[STACK_SIZE];
+    double *sp = stack;
+    double acc = 0;
+    const uint8_t *pc = prog->code;
+    const double *k = prog->consts;
+    for (;;) {
+        switch (*pc++) {
+            case OP_CONST: *sp++ = acc; acc = k[*pc++]; break;
+            case OP_VAR:   *sp++ = acc; acc = vars[*pc++]; break;
+            case OP_ADD:   acc = *--sp + acc; break;
+            case OP_SUB:   acc = *--sp - acc; break;
+            case OP_MUL:   acc = *--sp * acc; break;
+            case OP_DIV:   acc = *--sp / acc; break;
+            case OP_POW:   acc = pow(*--sp, acc); break;
+            case OP_ADDC:  acc += k[*pc++]; break;
+            case OP_SUBC:  acc -= k[*pc++]; break;
+            case OP_MULC:  acc *= k[*pc++]; break;
+            case OP_DIVC:  acc /= k[*pc++]; break;
+            case OP_ADDV:  acc += vars[*pc++]; break;
+            case OP_SUBV:  acc -= vars[*pc++]; break;
+            case OP_MULV:  acc *= vars[*pc++]; break;
+            case OP_DIVV:  acc /= vars[*pc++]; break;
+            case OP_NEG:   acc = -acc; break;
+            case OP_SQRT:  acc = sqrt(acc); break;
+            case OP_ABS:   acc = fabs(acc); break;
+            case OP_MIN:   acc = fmin(*--sp, acc); break;
+            case OP_MAX:   acc = fmax(*--sp, acc); break;
+            case OP_END:   return acc;
+        }
+    }
+}
+
+#if defined(__GNUC__)
+// Computed-goto dispatch: every handler jumps straight to the next one
+double runThreaded(const Program *prog, const double *vars) {
+    static void *const labels[OP_COUNT] = {
+#define X(name, args) [OP_##name] = &&do_##name,
+        OPCODES(X)
+#undef X
+    };
+    double stack[STACK_SIZE];
+    double *sp = stack;
+    double acc = 0;
+    const uint8_t *pc = prog->code;
+    const double *k = prog->consts;
+#define NEXT goto *labels[*pc++]
+
+    NEXT;
+do_CONST: *sp++ = acc; acc = k[*pc++]; NEXT;
+do_VAR:   *sp++ = acc; acc = vars[*pc++]; NEXT;
+do_ADD:   acc = *--sp + acc; NEXT;
+do_SUB:   acc = *--sp - acc; NEXT;
+do_MUL:   acc = *--sp * acc; NEXT;
+do_DIV:   acc = *--sp / acc; NEXT;
+do_POW:   acc = pow(*--sp, acc); NEXT;
+do_ADDC:  acc += k[*pc++]; NEXT;
+do_SUBC:  acc -= k[*pc++]; NEXT;
+do_MULC:  acc *= k[*pc++]; NEXT;
+do_DIVC:  acc /= k[*pc++]; NEXT;
+do_ADDV:  acc += vars[*pc++]; NEXT;
+do_SUBV:  acc -= vars[*pc++]; NEXT;
+do_MULV:  acc *= vars[*pc++]; NEXT;
+do_DIVV:  acc /= vars[*pc++]; NEXT;
+do_NEG:   acc = -acc; NEXT;
+do_SQRT:  acc = sqrt(acc); NEXT;
+do_ABS:   acc = fabs(acc); NEXT;
+do_MIN:   acc = fmin(*--sp, acc); NEXT;
+do_MAX:   acc = fmax(*--sp, acc); NEXT;
+do_END:   return acc;
+#undef NEXT
+}
+#else
+#define runThreaded runSwitch
+#endif
+
+// Function to evaluate n records, one instruction at a time over blocks of BLOCK records
+// columns[v][i] is the value of variable v in record i
+void runBatch(const Program *prog, const double *const *columns, size_t n, double *out) {
+    double stack[STACK_SIZE + 1][BLOCK];
+    for (size_t start = 0; start < n; start += BLOCK) {
+        size_t m = n - start < BLOCK ? n - start : BLOCK;
+        double *acc = stack[0];      // stack[depth] holds the current top block
+        const uint8_t *pc = prog->code;
+        int depth = -1;
+        for (;;) {
+            int op = *pc++;
+            int arg = opArgs[op] ? *pc++ : 0;
+            double *below = depth > 0 ? stack[depth - 1] : NULL;
+            const double *col = NULL;
+            if (op == OP_VAR || (op >= OP_ADDV && op <= OP_DIVV)) col = columns[arg] + start;
+            double c = prog->consts[arg];
+            size_t i;
+            switch (op) {
+                case OP_CONST: acc = stack[++depth]; for (i = 0; i < m; i++) acc[i] = c; break;
+                case OP_VAR:   acc = stack[++depth]; memcpy(acc, col, m * sizeof(double)); break;
+                case OP_ADD:   for (i = 0; i < m; i++) below[i] = below[i] + acc[i]; acc = stack[--depth]; break;
+                case OP_SUB:   for (i = 0; i < m; i++) below[i] = below[i] - acc[i]; acc = stack[--depth]; break;
+                case OP_MUL:   for (i = 0; i < m; i++) below[i] = below[i] * acc[i]; acc = stack[--depth]; break;
+                case OP_DIV:   for (i = 0; i < m; i++) below[i] = below[i] / acc[i]; acc = stack[--depth]; break;
+                case OP_POW:   for (i = 0; i < m; i++) below[i] = pow(below[i], acc[i]); acc = stack[--depth]; break;
+                case OP_MIN:   for (i = 0; i < m; i++) below[i] = fmin(below[i], acc[i]); acc = stack[--depth]; break;
+                case OP_MAX:   for (i = 0; i < m; i++) below[i] = fmax(below[i], acc[i]); acc = stack[--depth]; break;
+                case OP_ADDC:  for (i = 0; i < m; i++) acc[i] += c; break;
+                case OP_SUBC:  for (i = 0; i < m; i++) acc[i] -= c; break;
+                case OP_MULC:  for (i = 0; i < m; i++) acc[i] *= c; break;
+                case OP_DIVC:  for (i = 0; i < m; i++) acc[i] /= c; break;
+                case OP_ADDV:  for (i = 0; i < m; i++) acc[i] += col[i]; break;
+                case OP_SUBV:  for (i = 0; i < m; i++) acc[i] -= col[i]; break;
+                case OP_MULV:  for (i = 0; i < m; i++) acc[i] *= col[i]; break;
+                case OP_DIVV:  for (i = 0; i < m; i++) acc[i] /= col[i]; break;
+                case OP_NEG:   for (i = 0; i < m; i++) acc[i] = -acc[i]; break;
+                case OP_SQRT:  for (i = 0; i < m; i++) acc[i] = sqrt(acc[i]); break;
+                case OP_ABS:   for (i = 0; i < m; i++) acc[i] = fabs(acc[i]); break;
+                case OP_END:   memcpy(out + start, acc, m * sizeof(double)); goto nextBlock;
+            }
+        }
+nextBlock:;
+    }
+}
+
+/* ---------- Demo and benchmark ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The default formula written directly in C, for comparison
+double nativeFormula(const double *v) {
+    return v[0] * v[0] + 3 * v[1] - sqrt(fabs(v[2])) / 2;
+}
+
+typedef double (*RowFunction)(const void *context, const double *vars);
+
+double treeRow(const void *context, const double *vars) { return evalTree(context, vars); }
+double switchRow(const void *context, const double *vars) { return runSwitch(context, vars); }
+double threadedRow(const void *context, const double *vars) { return runThreaded(context, vars); }
+double nativeRow(const void *context, const double *vars) { (void)context; return nativeFormula(vars); }
+
+// Function to time one evaluator over all records; returns nanoseconds per record
+double timeRows(RowFunction f, const void *context, double **columns, int varCount, size_t n, double *out) {
+    double vars[MAX_VARS];
+    double start = nowSeconds();
+    for (size_t i = 0; i < n; i++) {
+        for (int v = 0; v < varCount; v++) vars[v] = columns[v][i];
+        out[i] = f(context, vars);
+    }
+    return (nowSeconds() - start) * 1e9 / n;
+}
+
+// Function to check the stack limit: x - (x - (... - (x - y))) needs one slot per x
+int checkStackLimit(void) {
+    char formula[16 * STACK_SIZE];
+    int ok = 1;
+    for (int levels = STACK_SIZE - 1; levels <= STACK_SIZE; levels++) {
+        int length = 0;
+        for (int i = 0; i < levels; i++) length += sprintf(formula + length, "x - (");
+        length += sprintf(formula + length, "x - y");
+        for (int i = 0; i < levels; i++) formula[length++] = ')';
+        formula[length] = '\0';
+        Parser parser;
+        Program prog;
+        Node *root = parseFormula(&parser, formula);
+        if (root == NULL) return 0;
+        int failed = compileProgram(&prog, root, parser.varCount);
+        if (failed) {
+            printf("Stack depth %d: rejected (%s)\n", prog.maxDepth, prog.error);
+            ok &= prog.maxDepth > STACK_SIZE;
+        } else {
+            // With an odd number of subtractions the result is x - y, with an even number y
+            double vars[2] = {5, 3}, expected = (levels + 1) % 2 ? 2 : 3;
+            double a = runSwitch(&prog, vars), b = runThreaded(&prog, vars);
+            printf("Stack depth %d: runs, result %g and %g (expected %g)\n", prog.maxDepth, a, b, expected);
+            ok &= prog.maxDepth <= STACK_SIZE && a == expected && b == expected;
+        }
+        freeTree(root);
+    }
+    return ok;
+}
+
+// Function to compare results bit for bit (NaN results compare equal to NaN)
+int sameResults(const double *x, const double *y, size_t n) {
+    return memcmp(x, y, n * sizeof(double)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *defaultFormula = "x * x + 3 * y - sqrt(abs(z)) / 2";
+    const char *formula = argc > 1 ? argv[1] : defaultFormula;
+    size_t n = argc > 2 ? (size_t)atol(argv[2]) : 2000000;
+
+    // Constant folding and error reporting on a few small formulas
+    const char *samples[] = {"(1 + 2) * x - 2^3^2 / 64", "max(a, b) * -c", "3 * (x + 1", "x + $"};
+    for (int s = 0; s < 4; s++) {
+        Parser parser;
+        Program prog;
+        Node *root = parseFormula(&parser, samples[s]);
+        if (root == NULL) {
+            printf("%-28s -> error: %s\n", samples[s], parser.error);
+            continue;
+        }
+        compileProgram(&prog, root, parser.varCount);
+        printf("%-28s -> %d bytes:", samples[s], prog.length);
+        for (int pc = 0; pc < prog.length;) {
+            printf(pc == 0 ? " " : ", ");
+            pc = printInstruction(&prog, &parser, pc);
+        }
+        printf("\n");
+        freeTree(root);
+    }
+    if (!checkStackLimit()) {
+        printf("Stack limit check failed.\n");
+        return 1;
+    }
+
+    Parser parser;
+    Program prog;
+    Node *tree = parseFormula(&parser, formula);
+    if (tree == NULL) {
+        printf("Error in \"%s\": %s\n", formula, parser.error);
+        return 1;
+    }
+    // One copy stays a tree for the baseline, the other is folded and compiled
+    Parser copy;
+    Node *compiled = parseFormula(&copy, formula);
+    if (compileProgram(&prog, compiled, parser.varCount)) {
+        printf("Error in \"%s\": %s\n", formula, prog.error);
+        return 1;
+    }
+    freeTree(compiled);
+    printf("\nFormula: %s\nBytecode (%d bytes, max stack depth %d):\n", formula, prog.length, prog.maxDepth);
+    disassemble(&prog, &parser);
+
+    // Random records, one column per variable
+    double *columns[MAX_VARS];
+    double *results[5];
+    for (int v = 0; v < parser.varCount; v++) columns[v] = malloc(n * sizeof(double));
+    for (int r = 0; r < 5; r++) results[r] = malloc(n * sizeof(double));
+    for (int v = 0; v < parser.varCount; v++) {
+        if (columns[v] == NULL) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+    }
+    for (int r = 0; r < 5; r++) {
+        if (results[r] == NULL) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (int v = 0; v < parser.varCount; v++) {
+        for (size_t i = 0; i < n; i++) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            columns[v][i] = (double)(state >> 11) / (1ULL << 53) * 200 - 100;
+        }
+    }
+
+    int isDefault = strcmp(formula, defaultFormula) == 0;
+    timeRows(threadedRow, &prog, columns, parser.varCount, n, results[2]);   // Warm-up
+    double treeTime = timeRows(treeRow, tree, columns, parser.varCount, n, results[0]);
+    double switchTime = timeRows(switchRow, &prog, columns, parser.varCount, n, results[1]);
+    double threadedTime = timeRows(threadedRow, &prog, columns, parser.varCount, n, results[2]);
+    double start = nowSeconds();
+    runBatch(&prog, (const double *const *)columns, n, results[3]);
+    double batchTime = (nowSeconds() - start) * 1e9 / n;
+
+    printf("\n%zu records, ns per record:\n", n);
+    printf("  tree walking:            %6.2f\n", treeTime);
+    printf("  bytecode, switch:        %6.2f\n", switchTime);
+    printf("  bytecode, computed goto: %6.2f\n", threadedTime);
+    printf("  bytecode, blocks of %d: %6.2f\n", BLOCK, batchTime);
+    if (isDefault) {
+        double nativeTime = timeRows(nativeRow, NULL, columns, parser.varCount, n, results[4]);
+        printf("  native C:                %6.2f\n", nativeTime);
+    }
+    int match = sameResults(results[0], results[1], n) && sameResults(results[0], results[2], n) &&
+                sameResults(results[0], results[3], n);
+    printf("  Results match: %s\n", match ? "yes" : "no");
+
+    freeTree(tree);
+    for (int v = 0; v < parser.varCount; v++) free(columns[v]);
+    for (int r = 0; r < 5; r++) free(results[r]);
+    return 0;
+}
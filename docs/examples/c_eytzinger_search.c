@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/*
+    CACHE-FRIENDLY SEARCH IN SORTED ARRAYS
+
+    Why plain binary search is slow on big arrays:
+    - The guessing game is a binary search: each guess halves the range.
+    - On a sorted array the first probes jump far apart (n/2, n/4, ...),
+      so every probe is a cache miss. The next probe depends on the
+      current one, so the CPU waits for main memory over and over.
+    - The "if (a[mid] < x)" branch is taken 50% of the time at random,
+      so the branch predictor guesses wrong half the time.
+
+    Eytzinger layout:
+    - Store the keys in the order a breadth-first walk of the binary search
+      tree visits them: b[1] is the root, the children of b[k] are b[2k]
+      and b[2k+1]. (This is the layout used for binary heaps.)
+    - The first levels of the tree sit next to each other and stay in
+      cache, and the 16 descendants four levels below b[k] share one
+      64-byte cache line at b[16k], so it can be prefetched early.
+
+    Branchless search:
+    - k = 2 * k + (b[k] < x) replaces the if/else with arithmetic.
+    - At the end, k has walked past a leaf. The lower bound is the last
+      node where we went left, found by removing the trailing 1 bits of k
+      plus one more bit: k >>= ffs(~k).
+
+    Batched search:
+    - Many independent queries walk down the tree one level at a time, in
+      turns. While one query waits for memory, the others keep working,
+      so several cache misses are in flight at once.
+
+    Usage:
+        eytzinger_search [max_size] [queries]
+*/
+
+typedef struct {
+    int *b;      // b[1..n] in Eytzinger order (b[0] is unused)
+    size_t n;
+    int depth;   // Number of tree levels
+} EytzingerIndex;
+
+// Function to copy sorted a[] into Eytzinger order with an in-order walk
+size_t eytzingerFill(const int *a, int *b, size_t i, size_t k, size_t n) {
+    if (k <= n) {
+        i = eytzingerFill(a, b, i, 2 * k, n);
+        b[k] = a[i++];
+        i = eytzingerFill(a, b, i, 2 * k + 1, n);
+    }
+    return i;
+}
+
+int eytzingerBuild(EytzingerIndex *index, const int *sorted, size_t n) {
+    // 64-byte alignment puts b[16k .. 16k+15] in one cache line
+    size_t bytes = ((n + 1) * sizeof(int) + 63) / 64 * 64;
+    index->b = (int *)aligned_alloc(64, bytes);
+    if (index->b == NULL) return -1;
+    index->n = n;
+    index->depth = 0;
+    for (size_t k = n; k > 0; k >>= 1) index->depth++;
+    eytzingerFill(sorted, index->b, 0, 1, n);
+    return 0;
+}
+
+// Function to find the Eytzinger index of the first key >= x (0 if none)
+size_t eytzingerLowerBound(const EytzingerIndex *index, int x) {
+    const int *b = index->b;
+    size_t k = 1;
+    while (k <= index->n) {
+        __builtin_prefetch(b + k * 16);
+        k = 2 * k + (b[k] < x);
+    }
+    k >>= __builtin_ffsll(~(long long)k);
+    return k;
+}
+
+// Function to answer many lower-bound queries level by level (interleaved)
+#define BATCH 16
+void eytzingerLowerBoundBatch(const EytzingerIndex *index, const int *queries, size_t *out, size_t count) {
+    const int *b = index->b;
+    size_t n = index->n;
+    for (size_t start = 0; start < count; start += BATCH) {
+        size_t m = count - start < BATCH ? count - start : BATCH;
+        size_t k[BATCH];
+        for (size_t q = 0; q < m; q++) k[q] = 1;
+        for (int level = 0; level < index->depth; level++) {
+            for (size_t q = 0; q < m; q++) {
+                // Only the last level can be partly filled, so this branch
+                // is almost always taken and predicts well
+                if (k[q] <= n) {
+                    __builtin_prefetch(b + k[q] * 16);
+                    k[q] = 2 * k[q] + (b[k[q]] < queries[start + q]);
+                }
+            }
+        }
+        for (size_t q = 0; q < m; q++) {
+            out[start + q] = k[q] >> __builtin_ffsll(~(long long)k[q]);
+        }
+    }
+}
+
+// Function for a branchless binary search on the sorted array (for comparison)
+size_t branchlessLowerBound(const int *a, size_t n, int x) {
+    const int *base = a;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = base[half - 1] < x ? base + half : base;
+        n -= half;
+    }
+    return (base - a) + (n == 1 && *base < x);
+}
+
+int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t rngState = 0x2545F4914F6CDD1DULL;
+
+uint32_t nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (uint32_t)(rngState >> 32);
+}
+
+// Function to time every search method on one array size
+void benchmarkSize(size_t n, size_t queryCount) {
+    int *sorted = (int *)malloc(n * sizeof(int));
+    int *queries = (int *)malloc(queryCount * sizeof(int));
+    size_t *results = (size_t *)malloc(queryCount * sizeof(size_t));
+    EytzingerIndex index;
+    if (sorted == NULL || queries == NULL || results == NULL) {
+        printf("Out of memory for n = %zu\n", n);
+        exit(1);
+    }
+
+    // Even numbers 0, 2, 4, ... so that about half the queries are misses
+    for (size_t i = 0; i < n; i++) sorted[i] = (int)(2 * i);
+    for (size_t q = 0; q < queryCount; q++) queries[q] = (int)(nextRandom() % (2 * n + 1));
+    if (eytzingerBuild(&index, sorted, n) != 0) {
+        printf("Out of memory for n = %zu\n", n);
+        exit(1);
+    }
+
+    // bsearch() only finds exact matches, so it answers the "is it there?" question
+    double start = nowSeconds();
+    size_t found = 0;
+    for (size_t q = 0; q < queryCount; q++) {
+        found += bsearch(&queries[q], sorted, n, sizeof(int), compareInts) != NULL;
+    }
+    double bsearchTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    size_t checksum = 0;
+    for (size_t q = 0; q < queryCount; q++) checksum += branchlessLowerBound(sorted, n, queries[q]);
+    double branchlessTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    size_t eytzingerFound = 0;
+    for (size_t q = 0; q < queryCount; q++) {
+        size_t k = eytzingerLowerBound(&index, queries[q]);
+        eytzingerFound += k != 0 && index.b[k] == queries[q];
+    }
+    double eytzingerTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    eytzingerLowerBoundBatch(&index, queries, results, queryCount);
+    double batchTime = nowSeconds() - start;
+
+    // Check that every method agrees
+    int ok = found == eytzingerFound;
+    for (size_t q = 0; q < queryCount && ok; q++) {
+        size_t rank = branchlessLowerBound(sorted, n, queries[q]);
+        int expected = rank < n ? sorted[rank] : -1;
+        int got = results[q] != 0 ? index.b[results[q]] : -1;
+        ok = expected == got;
+    }
+
+    double scale = 1e9 / queryCount;
+    printf("%12zu | %8.1f | %10.1f | %9.1f | %7.1f | %s\n", n, bsearchTime * scale,
+           branchlessTime * scale, eytzingerTime * scale, batchTime * scale, ok ? "ok" : "MISMATCH");
+    (void)checksum;
+
+    free(index.b);
+    free(sorted);
+    free(queries);
+    free(results);
+}
+
+int main(int argc, char *argv[]) {
+    // The guessing game as a lookup: where is 42 among 1..100?
+    int numbers[100];
+    for (int i = 0; i < 100; i++) numbers[i] = i + 1;
+    EytzingerIndex small;
+    if (eytzingerBuild(&small, numbers, 100) != 0) return 1;
+    size_t k = eytzingerLowerBound(&small, 42);
+    printf("Lower bound of 42 in 1..100: %d (tree has %d levels)\n", small.b[k], small.depth);
+    free(small.b);
+
+    // 1 billion ints needs about 8 GB (sorted copy + index); pass it explicitly
+    size_t maxSize = argc > 1 ? (size_t)atoll(argv[1]) : (size_t)1 << 24;
+    size_t queryCount = argc > 2 ? (size_t)atoll(argv[2]) : 1000000;
+    if (maxSize > 1073741823) maxSize = 1073741823;   // Keys (2 * i) must fit in an int
+
+    printf("\nNanoseconds per query (%zu random queries)\n", queryCount);
+    printf("%12s | %8s | %10s | %9s | %7s | check\n", "n", "bsearch", "branchless", "eytzinger", "batched");
+    for (size_t n = 1000; n <= maxSize; n *= 4) {
+        benchmarkSize(n, queryCount);
+    }
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+    FAST SUBSTRING SEARCH IN C (a small grep)
+
+    Single pattern - first/last byte filter:
+    - Compare 16 positions at once with SSE2: is the byte at i the
+      pattern's first byte AND is the byte at i + m - 1 its last byte?
+    - Only positions that pass both tests are checked with memcmp().
+      On normal text almost none pass, so the loop runs at nearly memory
+      speed.
+    - Without SSE2 the same idea is done with memchr() on the first byte.
+
+    Several patterns - Aho-Corasick:
+    - All patterns go into one trie. Failure links turn the trie into an
+      automaton that reads every input byte exactly once, no matter how
+      many patterns there are.
+    - The transitions are stored as a full 256-entry table per state, so
+      each byte costs a single array lookup.
+
+    Reading files:
+    - Files are mapped with mmap(), so the search runs directly on the
+      kernel's page cache with no read() copies.
+    - The mapping is cut into slices at line boundaries, one per thread
+      and at most SLICE_SIZE bytes each. Each thread collects its matching
+      lines in its own buffer. After each round of slices the buffers are
+      printed in order and reused, so the memory for output stays bounded
+      however large the file is.
+
+    Usage:
+        fast_search [-c] [-j threads] PATTERN FILE...
+        fast_search [-c] [-j threads] -e PATTERN [-e PATTERN ...] FILE...
+*/
+
+#define MAX_PATTERNS 64
+#define MAX_THREADS 64
+#define SLICE_SIZE (8 << 20)    // Largest slice searched by one thread in one round
+
+typedef struct {
+    int patternCount;
+    const char *patterns[MAX_PATTERNS];
+    size_t lengths[MAX_PATTERNS];
+    int (*table)[256];      // Aho-Corasick transitions (several patterns)
+    char *accepting;        // Aho-Corasick: state ends at least one pattern
+} Searcher;
+
+/*
+    Single pattern search.
+    Returns a pointer to the first match in [p, end), or NULL.
+*/
+const char *findSingle(const char *needle, size_t m, const char *p, const char *end) {
+    if (m == 0) return p;
+    if ((size_t)(end - p) < m) return NULL;
+    const char *last = end - m;     // Last valid start position
+#ifdef __SSE2__
+    if (m > 1) {
+        __m128i first = _mm_set1_epi8(needle[0]);
+        __m128i final = _mm_set1_epi8(needle[m - 1]);
+        while (p + 16 <= last + 1) {
+            __m128i blockFirst = _mm_loadu_si128((const __m128i *)p);
+            __m128i blockLast = _mm_loadu_si128((const __m128i *)(p + m - 1));
+            unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                                            _mm_cmpeq_epi8(blockLast, final)));
+            while (mask != 0) {
+                int bit = __builtin_ctz(mask);
+                if (memcmp(p + bit + 1, needle + 1, m - 2) == 0) {
+                    return p + bit;
+                }
+                mask &= mask - 1;
+            }
+            p += 16;
+        }
+    }
+#endif
+    // Scalar part (and the tail that does not fill a whole 16-byte block)
+    while (p <= last) {
+        p = (const char *)memchr(p, needle[0], last - p + 1);
+        if (p == NULL) return NULL;
+        if (memcmp(p, needle, m) == 0) return p;
+        p++;
+    }
+    return NULL;
+}
+
+// Function to build the Aho-Corasick automaton for all patterns
+int buildAutomaton(Searcher *s) {
+    size_t maxStates = 1;
+    for (int i = 0; i < s->patternCount; i++) maxStates += s->lengths[i];
+
+    s->table = calloc(maxStates, sizeof(*s->table));
+    s->accepting = calloc(maxStates, 1);
+    int *fail = calloc(maxStates, sizeof(int));
+    int *queue = calloc(maxStates, sizeof(int));
+    if (s->table == NULL || s->accepting == NULL || fail == NULL || queue == NULL) {
+        return -1;
+    }
+
+    // 1. Insert every pattern into the trie (0 means "no edge" for now)
+    int states = 1;
+    for (int i = 0; i < s->patternCount; i++) {
+        int state = 0;
+        for (size_t j = 0; j < s->lengths[i]; j++) {
+            unsigned char c = s->patterns[i][j];
+            if (s->table[state][c] == 0) s->table[state][c] = states++;
+            state = s->table[state][c];
+        }
+        s->accepting[state] = 1;
+    }
+
+    // 2. Breadth-first pass: fill missing edges using the failure links
+    int head = 0, tail = 0;
+    for (int c = 0; c < 256; c++) {
+        if (s->table[0][c] != 0) queue[tail++] = s->table[0][c];
+    }
+    while (head < tail) {
+        int state = queue[head++];
+        s->accepting[state] |= s->accepting[fail[state]];
+        for (int c = 0; c < 256; c++) {
+            int next = s->table[state][c];
+            if (next != 0) {
+                fail[next] = s->table[fail[state]][c];
+                queue[tail++] = next;
+            } else {
+                s->table[state][c] = s->table[fail[state]][c];
+            }
+        }
+    }
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+/*
+    Multi-pattern search.
+    Returns a pointer to the last byte of the first match in [p, end),
+    or NULL. Any byte of the match is enough to find its line.
+*/
+const char *findMulti(Searcher *s, const char *p, const char *end) {
+    int state = 0;
+    for (; p < end; p++) {
+        state = s->table[state][(unsigned char)*p];
+        if (s->accepting[state]) return p;
+    }
+    return NULL;
+}
+
+const char *findMatch(Searcher *s, const char *p, const char *end) {
+    if (s->patternCount == 1) {
+        return findSingle(s->patterns[0], s->lengths[0], p, end);
+    }
+    return findMulti(s, p, end);
+}
+
+/*
+    Output buffer used by each thread.
+*/
+typedef struct {
+    char *data;
+    size_t length, capacity;
+} OutBuffer;
+
+void outAppend(OutBuffer *out, const char *text, size_t n) {
+    if (out->length + n > out->capacity) {
+        size_t capacity = out->capacity ? out->capacity * 2 : 65536;
+        while (capacity < out->length + n) capacity *= 2;
+        out->data = realloc(out->data, capacity);
+        if (out->data == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+        out->capacity = capacity;
+    }
+    memcpy(out->data + out->length, text, n);
+    out->length += n;
+}
+
+typedef struct {
+    Searcher *searcher;
+    const char *begin, *end;   // Slice of the file (whole lines only)
+    const char *prefix;        // "file:" when several files are searched
+    int countOnly;
+    long matches;
+    OutBuffer out;
+} SliceJob;
+
+// Function run by each thread: find matching lines in one slice
+void *searchSlice(void *arg) {
+    SliceJob *job = (SliceJob *)arg;
+    const char *p = job->begin;
+    while (p < job->end) {
+        const char *hit = findMatch(job->searcher, p, job->end);
+        if (hit == NULL) break;
+        // Widen the hit to its whole line
+        const char *lineStart = hit;
+        while (lineStart > p && lineStart[-1] != '\n') lineStart--;
+        const char *lineEnd = memchr(hit, '\n', job->end - hit);
+        lineEnd = lineEnd != NULL ? lineEnd + 1 : job->end;
+
+        job->matches++;
+        if (!job->countOnly) {
+            if (job->prefix != NULL) outAppend(&job->out, job->prefix, strlen(job->prefix));
+            outAppend(&job->out, lineStart, lineEnd - lineStart);
+            if (lineEnd[-1] != '\n') outAppend(&job->out, "\n", 1);
+        }
+        p = lineEnd;   // Each line is reported at most once
+    }
+    return NULL;
+}
+
+// Function to search one file; returns the number of matching lines or -1
+long searchFile(Searcher *s, const char *path, int threads, int countOnly, int showName) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return 0;
+    }
+    const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    char prefix[4096];
+    snprintf(prefix, sizeof(prefix), "%s:", path);
+
+    SliceJob jobs[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (SliceJob){s, NULL, NULL, showName ? prefix : NULL, countOnly, 0, {NULL, 0, 0}};
+    }
+    const char *end = data + size;
+    const char *p = data;
+    long total = 0;
+    while (p < end) {
+        // Cut the next round of slices; each ends just after a newline
+        int used = 0;
+        for (int i = 0; i < threads && p < end; i++) {
+            size_t remaining = end - p;
+            size_t step = i == threads - 1 ? remaining : remaining / (threads - i);
+            if (step > SLICE_SIZE) step = SLICE_SIZE;
+            const char *sliceEnd = p + step;
+            if (sliceEnd < end) {
+                const char *nl = memchr(sliceEnd, '\n', end - sliceEnd);
+                sliceEnd = nl != NULL ? nl + 1 : end;
+            }
+            jobs[i].begin = p;
+            jobs[i].end = sliceEnd;
+            jobs[i].matches = 0;
+            jobs[i].out.length = 0;    // Keep the buffer from the last round
+            p = sliceEnd;
+            used++;
+        }
+        for (int i = 1; i < used; i++) {
+            pthread_create(&ids[i], NULL, searchSlice, &jobs[i]);
+        }
+        searchSlice(&jobs[0]);   // The main thread takes the first slice
+
+        for (int i = 0; i < used; i++) {
+            if (i > 0) pthread_join(ids[i], NULL);
+            if (jobs[i].out.length > 0) fwrite(jobs[i].out.data, 1, jobs[i].out.length, stdout);
+            total += jobs[i].matches;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        free(jobs[i].out.data);
+    }
+    munmap((void *)data, size);
+    return total;
+}
+
+int main(int argc, char *argv[]) {
+    Searcher searcher = {0};
+    int countOnly = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ce:j:")) != -1) {
+        if (opt == 'c') {
+            countOnly = 1;
+        } else if (opt == 'j') {
+            threads = atoi(optarg);
+        } else if (opt == 'e' && searcher.patternCount < MAX_PATTERNS) {
+            searcher.patterns[searcher.patternCount++] = optarg;
+        } else {
+            fprintf(stderr, "Usage: %s [-c] [-j threads] [-e PATTERN]... [PATTERN] FILE...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (searcher.patternCount == 0 && optind < argc) {
+        searcher.patterns[searcher.patternCount++] = argv[optind++];
+    }
+    if (searcher.patternCount == 0 || optind >= argc) {
+        fprintf(stderr, "Usage: %s [-c] [-j threads] [-e PATTERN]... [PATTERN] FILE...\n", argv[0]);
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    for (int i = 0; i < searcher.patternCount; i++) {
+        searcher.lengths[i] = strlen(searcher.patterns[i]);
+        if (searcher.lengths[i] == 0 || strchr(searcher.patterns[i], '\n') != NULL) {
+            fprintf(stderr, "Patterns must be non-empty and must not contain newlines.\n");
+            return 2;
+        }
+    }
+    if (searcher.patternCount > 1 && buildAutomaton(&searcher) != 0) {
+        fprintf(stderr, "Out of memory.\n");
+        return 2;
+    }
+
+    int fileCount = argc - optind;
+    long total = 0;
+    int failed = 0;
+    for (int i = optind; i < argc; i++) {
+        long found = searchFile(&searcher, argv[i], threads, countOnly, fileCount > 1);
+        if (found < 0) {
+            failed = 1;
+            continue;
+        }
+        if (countOnly && fileCount > 1) {
+            printf("%s:%ld\n", argv[i], found);
+        }
+        total += found;
+    }
+    if (countOnly) {
+        printf("%ld\n", total);
+    } else {
+        fprintf(stderr, "%ld matching line(s)\n", total);
+    }
+
+    free(searcher.table);
+    free(searcher.accepting);
+    if (failed) return 2;
+    return total > 0 ? 0 : 1;   // Same exit codes as grep
+}
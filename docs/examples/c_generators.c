@@ -0,0 +1,423 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/*
+    LAZY LINE AND TOKEN STREAMS WITH GENERATORS
+
+    Eager Loops:
+    - The line and word examples read the whole file in one loop and do
+      all their work inside it. To reuse "split into lines" or "split into
+      words", the steps must be copied into every loop, or the results must
+      be collected into arrays first.
+
+    Generators:
+    - A generator is a function that returns one element per call and
+      continues where it stopped on the next call. The caller pulls
+      elements one at a time, so nothing is computed before it is needed.
+    - C has no 'yield', but a switch statement can jump back into the
+      middle of a function: GEN_YIELD saves the line number in 'state' and
+      returns, and the next call jumps to the matching case label. These
+      are stackless coroutines: local variables are lost at a yield, so
+      everything that must survive lives in the generator struct.
+
+    Composition:
+    - Every generator has the same interface (a Stream), so they can be
+      chained: lines -> tokens -> map -> filter -> take. Each stage pulls
+      from the one before it; no stage builds a list.
+    - Elements are StringViews (pointer + length) into the source buffer.
+      All generators live on the caller's stack: there is no allocation
+      per element and none per stage.
+    - Pulling stops when the consumer stops. A query that needs only the
+      first few matches reads only the start of the file.
+
+    Usage:
+        generators [-p PATTERN] [-n COUNT] [-l MIN_LENGTH] FILE
+*/
+
+#define READ_SIZE (64 * 1024)
+#define SCRATCH_SIZE 256
+
+// A generator returns 1 with an element, or 0 when it is finished
+#define GEN_BEGIN(g) switch ((g)->state) { case 0:
+#define GEN_YIELD(g) do { (g)->state = __LINE__; return 1; case __LINE__:; } while (0)
+#define GEN_END(g) } (g)->state = -1; return 0
+
+typedef struct {
+    const char *data;
+    size_t length;
+} StringView;
+
+typedef struct Stream Stream;
+struct Stream {
+    int (*next)(Stream *s, StringView *out);
+    int state;                      // Resume point for GEN_BEGIN
+};
+
+/* ---------- Sources ---------- */
+
+typedef struct {
+    Stream stream;
+    int fd;                         // -1 when the whole file is mapped
+    char *data;
+    size_t start, end, capacity;    // Unread bytes are data[start..end)
+    int eof;
+    int error;                      // errno of a failed read or allocation, 0 if none
+    size_t bytesRead;
+    char *newline;
+} Lines;
+
+// Function to move the unread bytes to the front and read more after them.
+// A line that fills the whole buffer doubles it, so every line is returned in one piece.
+void linesRefill(Lines *l) {
+    if (l->start == 0 && l->end == l->capacity) {
+        char *bigger = realloc(l->data, l->capacity * 2);
+        if (bigger == NULL) {
+            l->error = ENOMEM;
+            l->eof = 1;
+            return;
+        }
+        l->data = bigger;
+        l->capacity *= 2;
+    }
+    memmove(l->data, l->data + l->start, l->end - l->start);
+    l->end -= l->start;
+    l->start = 0;
+    ssize_t got;
+    do {
+        got = read(l->fd, l->data + l->end, l->capacity - l->end);
+    } while (got < 0 && errno == EINTR);
+    if (got < 0) {
+        l->error = errno;
+        l->eof = 1;
+    } else if (got == 0) {
+        l->eof = 1;
+    } else {
+        l->end += got;
+        l->bytesRead += got;
+    }
+}
+
+// Function to produce the lines of the source without their '\n'; a view is valid until the next call
+int linesNext(Stream *s, StringView *out) {
+    Lines *l = (Lines *)s;
+    GEN_BEGIN(s);
+    for (;;) {
+        l->newline = memchr(l->data + l->start, '\n', l->end - l->start);
+        if (l->newline != NULL) {
+            out->data = l->data + l->start;
+            out->length = l->newline - out->data;
+            l->start += out->length + 1;
+            GEN_YIELD(s);
+        } else if (!l->eof) {
+            linesRefill(l);
+        } else if (l->start < l->end && l->error == 0) {
+            // Last line without '\n'
+            out->data = l->data + l->start;
+            out->length = l->end - l->start;
+            l->start = l->end;
+            GEN_YIELD(s);
+        } else if (l->eof) {
+            break;
+        }
+    }
+    GEN_END(s);
+}
+
+// Function to read lines from a file through a buffer that starts at 'capacity' bytes; -1 if out of memory
+int linesFromFile(Lines *l, int fd, size_t capacity) {
+    *l = (Lines){ .stream = { linesNext, 0 }, .fd = fd, .data = malloc(capacity), .capacity = capacity };
+    return l->data != NULL ? 0 : -1;
+}
+
+// Function to release the buffer of a file source; returns -1 if the stream stopped on an error
+int linesClose(Lines *l, const char *path) {
+    if (l->fd >= 0) free(l->data);
+    if (l->error != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(l->error));
+        return -1;
+    }
+    return 0;
+}
+
+// Function to read lines from memory (e.g. a mapped file); nothing is copied
+void linesFromMemory(Lines *l, const char *data, size_t length) {
+    *l = (Lines){ .stream = { linesNext, 0 }, .fd = -1, .data = (char *)data,
+                  .end = length, .capacity = length, .eof = 1, .bytesRead = length };
+}
+
+/* ---------- Stages ---------- */
+
+typedef struct {
+    Stream stream;
+    Stream *source;
+    StringView line;
+    size_t position;
+} Tokens;
+
+// Function to split each line into words separated by spaces and tabs
+int tokensNext(Stream *s, StringView *out) {
+    Tokens *t = (Tokens *)s;
+    GEN_BEGIN(s);
+    while (t->source->next(t->source, &t->line)) {
+        t->position = 0;
+        for (;;) {
+            while (t->position < t->line.length &&
+                   (t->line.data[t->position] == ' ' || t->line.data[t->position] == '\t'))
+                t->position++;
+            if (t->position == t->line.length) break;
+            out->data = t->line.data + t->position;
+            while (t->position < t->line.length &&
+                   t->line.data[t->position] != ' ' && t->line.data[t->position] != '\t')
+                t->position++;
+            out->length = t->line.data + t->position - out->data;
+            GEN_YIELD(s);
+        }
+    }
+    GEN_END(s);
+}
+
+void tokens(Tokens *t, Stream *source) {
+    *t = (Tokens){ .stream = { tokensNext, 0 }, .source = source };
+}
+
+typedef struct {
+    Stream stream;
+    Stream *source;
+    int (*keep)(StringView element, const void *context);
+    const void *context;
+} Filter;
+
+// Function to pass on only the elements accepted by 'keep'
+int filterNext(Stream *s, StringView *out) {
+    Filter *f = (Filter *)s;
+    while (f->source->next(f->source, out)) {
+        if (f->keep(*out, f->context)) return 1;
+    }
+    return 0;
+}
+
+void filter(Filter *f, Stream *source, int (*keep)(StringView, const void *), const void *context) {
+    *f = (Filter){ .stream = { filterNext, 0 }, .source = source, .keep = keep, .context = context };
+}
+
+typedef struct {
+    Stream stream;
+    Stream *source;
+    StringView (*transform)(StringView element, char *scratch, size_t size);
+    char scratch[SCRATCH_SIZE];     // Room for a transformed element, reused on every call
+} Map;
+
+// Function to pass on each element after 'transform'
+int mapNext(Stream *s, StringView *out) {
+    Map *m = (Map *)s;
+    StringView element;
+    if (!m->source->next(m->source, &element)) return 0;
+    *out = m->transform(element, m->scratch, sizeof(m->scratch));
+    return 1;
+}
+
+void map(Map *m, Stream *source, StringView (*transform)(StringView, char *, size_t)) {
+    *m = (Map){ .stream = { mapNext, 0 }, .source = source, .transform = transform };
+}
+
+typedef struct {
+    Stream stream;
+    Stream *source;
+    size_t remaining;
+} Take;
+
+// Function to pass on at most 'count' elements; afterwards the source is never called again
+int takeNext(Stream *s, StringView *out) {
+    Take *t = (Take *)s;
+    if (t->remaining == 0) return 0;
+    t->remaining--;
+    return t->source->next(t->source, out);
+}
+
+void take(Take *t, Stream *source, size_t count) {
+    *t = (Take){ .stream = { takeNext, 0 }, .source = source, .remaining = count };
+}
+
+typedef struct {
+    Stream stream;
+    Stream *source;
+    size_t count;
+} Counter;
+
+// Function to pass on every element unchanged while counting them
+int counterNext(Stream *s, StringView *out) {
+    Counter *c = (Counter *)s;
+    if (!c->source->next(c->source, out)) return 0;
+    c->count++;
+    return 1;
+}
+
+void counter(Counter *c, Stream *source) {
+    *c = (Counter){ .stream = { counterNext, 0 }, .source = source };
+}
+
+/* ---------- Predicates and transforms ---------- */
+
+int containsPattern(StringView element, const void *context) {
+    const char *pattern = context;
+    return memmem(element.data, element.length, pattern, strlen(pattern)) != NULL;
+}
+
+int isLongWord(StringView element, const void *context) {
+    return element.length >= *(const size_t *)context;
+}
+
+StringView toLowercase(StringView element, char *scratch, size_t size) {
+    size_t n = element.length < size ? element.length : size;
+    for (size_t i = 0; i < n; i++) scratch[i] = tolower((unsigned char)element.data[i]);
+    return (StringView){ scratch, n };
+}
+
+/* ---------- Demo ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to count lines and words with the eager loop of the text processing examples
+void countEager(const char *data, size_t length, size_t *lines, size_t *words) {
+    int inWord = 0;
+    *lines = *words = 0;
+    for (size_t i = 0; i < length; i++) {
+        char ch = data[i];
+        if (ch == '\n') (*lines)++;
+        if (ch == ' ' || ch == '\n' || ch == '\t') {
+            inWord = 0;
+        } else if (inWord == 0) {
+            inWord = 1;
+            (*words)++;
+        }
+    }
+    if (length > 0 && data[length - 1] != '\n') (*lines)++;     // Last line without '\n'
+}
+
+// Function to count lines and words by pulling from generators: lines -> counter -> tokens
+void countGenerators(Stream *lineSource, size_t *lines, size_t *words) {
+    Counter lineCounter;
+    Tokens wordStream;
+    StringView element;
+    counter(&lineCounter, lineSource);
+    tokens(&wordStream, &lineCounter.stream);
+    *words = 0;
+    while (wordStream.stream.next(&wordStream.stream, &element)) (*words)++;
+    *lines = lineCounter.count;
+}
+
+// Function to print every element of a stream, shortened to fit a line
+void printStream(Stream *s) {
+    StringView element;
+    while (s->next(s, &element)) {
+        int shown = element.length > 70 ? 70 : (int)element.length;
+        printf("  %.*s%s\n", shown, element.data, element.length > 70 ? "..." : "");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *pattern = "error";
+    size_t count = 5, minLength = 12;
+    int option;
+    while ((option = getopt(argc, argv, "p:n:l:")) != -1) {
+        if (option == 'p') pattern = optarg;
+        else if (option == 'n') count = strtoul(optarg, NULL, 10);
+        else if (option == 'l') minLength = strtoul(optarg, NULL, 10);
+        else return 1;
+    }
+    if (optind != argc - 1) {
+        printf("Usage: %s [-p PATTERN] [-n COUNT] [-l MIN_LENGTH] FILE\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[optind];
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *mapped = "";
+    if (size > 0) {
+        mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+    }
+    Lines lines;
+    size_t eagerLines, eagerWords, genLines, genWords;
+
+    // 1. The same counts three ways
+    printf("%s: %zu bytes\n", path, size);
+    double start = nowSeconds();
+    countEager(mapped, size, &eagerLines, &eagerWords);
+    printf("Eager loop:             lines %zu, words %zu  %.3f s\n", eagerLines, eagerWords, nowSeconds() - start);
+
+    start = nowSeconds();
+    linesFromMemory(&lines, mapped, size);
+    countGenerators(&lines.stream, &genLines, &genWords);
+    printf("Generators over mmap:   lines %zu, words %zu  %.3f s  %s\n", genLines, genWords,
+           nowSeconds() - start, genLines == eagerLines && genWords == eagerWords ? "(same)" : "(DIFFERENT)");
+
+    start = nowSeconds();
+    if (linesFromFile(&lines, fd, 1 << 20) != 0) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    countGenerators(&lines.stream, &genLines, &genWords);
+    if (linesClose(&lines, path) != 0) return 1;
+    printf("Generators over read(): lines %zu, words %zu  %.3f s  %s\n", genLines, genWords,
+           nowSeconds() - start, genLines == eagerLines && genWords == eagerWords ? "(same)" : "(DIFFERENT)");
+
+    // 2. Stop early: the first lines that contain the pattern
+    Filter matching;
+    Take firstLines;
+    lseek(fd, 0, SEEK_SET);
+    if (linesFromFile(&lines, fd, READ_SIZE) != 0) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    filter(&matching, &lines.stream, containsPattern, pattern);
+    take(&firstLines, &matching.stream, count);
+    printf("\nFirst %zu lines containing \"%s\":\n", count, pattern);
+    printStream(&firstLines.stream);
+    if (linesClose(&lines, path) != 0) return 1;
+    printf("Read %zu of %zu bytes\n", lines.bytesRead, size);
+
+    // 3. Stop early: lines -> tokens -> lowercase -> long words only -> first few
+    Tokens words;
+    Map lowercase;
+    Filter longWords;
+    Take firstWords;
+    lseek(fd, 0, SEEK_SET);
+    if (linesFromFile(&lines, fd, READ_SIZE) != 0) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    tokens(&words, &lines.stream);
+    map(&lowercase, &words.stream, toLowercase);
+    filter(&longWords, &lowercase.stream, isLongWord, &minLength);
+    take(&firstWords, &longWords.stream, count);
+    printf("\nFirst %zu words of at least %zu characters, lowercased:\n", count, minLength);
+    printStream(&firstWords.stream);
+    if (linesClose(&lines, path) != 0) return 1;
+    printf("Read %zu of %zu bytes\n", lines.bytesRead, size);
+
+    if (size > 0) munmap((void *)mapped, size);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,467 @@
+#define _GNU_SOURCE   // For accept4()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/*
+    EPOLL GUESSING GAME SERVER
+
+    One thread, thousands of players:
+    - c_number_guessing_game.c talks to one player on stdin/stdout.
+    - This server accepts many connections and keeps one game session per
+      connection. Instead of a thread per client, a single thread waits on
+      all sockets at once with epoll_wait() and only touches the sockets
+      that are ready.
+    - All sockets are non-blocking, so a slow client can never stall the
+      others.
+    - Backpressure: a client may send many lines without reading the
+      replies. When its output buffer is full, the server stops reading
+      from it (no EPOLLIN) until the client has read enough replies.
+      Requests wait in the socket; no reply is ever dropped.
+
+    Session slab:
+    - Sessions are allocated in blocks of SLAB_BLOCK structs and recycled
+      through a free list, so connecting and disconnecting does not call
+      malloc() per client. The epoll event carries a pointer to the
+      session, so no lookup table is needed.
+
+    Protocol (one line per message):
+        client: G <number>\n
+        server: LOW\n | HIGH\n | WIN <attempts>\n   (a new secret starts after WIN)
+
+    Addresses:
+        /path/to/socket        Unix domain socket
+        tcp:<port>             TCP on 127.0.0.1
+
+    Usage:
+        game_server server [address]
+        game_server client [address] [connections] [games]
+        game_server bench  [address] [connections] [games]   (both at once)
+*/
+
+#define DEFAULT_ADDRESS "/tmp/guessing_game.sock"
+#define SLAB_BLOCK 1024
+#define MAX_EVENTS 512
+#define LINE_MAX_LENGTH 32
+
+typedef struct Session {
+    int fd;
+    int secret;
+    int attempts;
+    char in[LINE_MAX_LENGTH];
+    int inLength;
+    char out[4 * LINE_MAX_LENGTH];
+    int outLength;
+    uint32_t events;          // Events registered with epoll
+    int closing;              // The client sent EOF; close once all replies are sent
+    struct Session *nextFree;
+} Session;
+
+static Session *freeList = NULL;
+static uint64_t rngState = 88172645463325252ULL;
+
+// Function to produce a random secret between 1 and 100 (xorshift64)
+int nextSecret(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (int)((rngState >> 32) * 100 >> 32) + 1;
+}
+
+// Function to take a session from the slab (adds a new block if empty)
+Session *sessionAlloc(void) {
+    if (freeList == NULL) {
+        Session *block = (Session *)malloc(SLAB_BLOCK * sizeof(Session));
+        if (block == NULL) return NULL;
+        for (int i = 0; i < SLAB_BLOCK; i++) {
+            block[i].nextFree = freeList;
+            freeList = &block[i];
+        }
+    }
+    Session *s = freeList;
+    freeList = s->nextFree;
+    return s;
+}
+
+void sessionRelease(Session *s) {
+    s->nextFree = freeList;
+    freeList = s;
+}
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Function to fill a sockaddr for "tcp:<port>" or a Unix socket path
+socklen_t makeAddress(const char *address, struct sockaddr_storage *storage, int *family) {
+    memset(storage, 0, sizeof(*storage));
+    if (strncmp(address, "tcp:", 4) == 0) {
+        struct sockaddr_in *in = (struct sockaddr_in *)storage;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)atoi(address + 4));
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        *family = AF_INET;
+        return sizeof(*in);
+    }
+    struct sockaddr_un *un = (struct sockaddr_un *)storage;
+    un->sun_family = AF_UNIX;
+    strncpy(un->sun_path, address, sizeof(un->sun_path) - 1);
+    *family = AF_UNIX;
+    return sizeof(*un);
+}
+
+// Function to raise the open-file limit so 10k+ sockets fit
+void raiseFileLimit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/*
+    Server side.
+*/
+
+// Function to check whether the longest reply might not fit into the output buffer
+int outputFull(const Session *s) {
+    return s->outLength + LINE_MAX_LENGTH > (int)sizeof(s->out);
+}
+
+// Function to register the events the session needs: input while replies fit, output while any are pending
+void updateEvents(int epfd, Session *s) {
+    uint32_t wanted = (s->closing || outputFull(s) ? 0 : EPOLLIN) | (s->outLength > 0 ? EPOLLOUT : 0);
+    if (wanted != s->events) {
+        struct epoll_event ev = {.events = wanted, .data.ptr = s};
+        epoll_ctl(epfd, EPOLL_CTL_MOD, s->fd, &ev);
+        s->events = wanted;
+    }
+}
+
+// Function to send pending output; returns -1 if the client is gone
+int flushOutput(Session *s) {
+    int sent = 0;
+    while (sent < s->outLength) {
+        ssize_t n = write(s->fd, s->out + sent, s->outLength - sent);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        sent += (int)n;
+    }
+    memmove(s->out, s->out + sent, s->outLength - sent);
+    s->outLength -= sent;
+    return 0;
+}
+
+// Function to answer one complete line from a client (the caller checks that the reply fits)
+void handleLine(Session *s, const char *line) {
+    int guess;
+    const char *reply;
+    char winLine[LINE_MAX_LENGTH];
+    if (sscanf(line, "G %d", &guess) != 1) {
+        reply = "ERR\n";
+    } else {
+        s->attempts++;
+        if (guess < s->secret) {
+            reply = "LOW\n";
+        } else if (guess > s->secret) {
+            reply = "HIGH\n";
+        } else {
+            snprintf(winLine, sizeof(winLine), "WIN %d\n", s->attempts);
+            reply = winLine;
+            s->secret = nextSecret();
+            s->attempts = 0;
+        }
+    }
+    int n = (int)strlen(reply);
+    memcpy(s->out + s->outLength, reply, n);
+    s->outLength += n;
+}
+
+// Function to answer the complete lines in the input buffer while their replies fit
+void handleLines(Session *s) {
+    char *newline;
+    while (!outputFull(s) && (newline = memchr(s->in, '\n', s->inLength)) != NULL) {
+        *newline = '\0';
+        handleLine(s, s->in);
+        int used = (int)(newline - s->in) + 1;
+        memmove(s->in, s->in + used, s->inLength - used);
+        s->inLength -= used;
+    }
+}
+
+// Function to read from a client until the socket is empty or the replies would not fit; -1 closes it
+int handleReadable(Session *s) {
+    while (!outputFull(s)) {
+        ssize_t n = read(s->fd, s->in + s->inLength, sizeof(s->in) - s->inLength);
+        if (n == 0) {
+            s->closing = 1;
+            return 0;
+        }
+        if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        s->inLength += (int)n;
+        handleLines(s);
+        if (s->inLength == (int)sizeof(s->in) && memchr(s->in, '\n', s->inLength) == NULL) return -1;   // Line too long
+    }
+    return 0;
+}
+
+// Function to send replies and answer waiting lines until the socket is full or nothing is left; -1 closes it
+int serviceSession(int epfd, Session *s) {
+    for (;;) {
+        if (s->outLength > 0 && flushOutput(s) < 0) return -1;
+        int before = s->outLength;
+        handleLines(s);
+        if (s->outLength == before) break;
+    }
+    if (s->closing && s->outLength == 0) return -1;     // Every reply was sent
+    updateEvents(epfd, s);
+    return 0;
+}
+
+void closeSession(int epfd, Session *s) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    sessionRelease(s);
+}
+
+int runServer(const char *address) {
+    struct sockaddr_storage storage;
+    int family;
+    socklen_t length = makeAddress(address, &storage, &family);
+
+    raiseFileLimit();
+    int listener = socket(family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    if (family == AF_UNIX) {
+        unlink(address);
+    } else {
+        int on = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+    if (bind(listener, (struct sockaddr *)&storage, length) < 0 || listen(listener, SOMAXCONN) < 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    int epfd = epoll_create1(0);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};   // NULL marks the listener
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listener, &ev);
+    printf("Server listening on %s\n", address);
+    fflush(stdout);
+
+    struct epoll_event events[MAX_EVENTS];
+    for (;;) {
+        int ready = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (ready < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < ready; i++) {
+            Session *s = (Session *)events[i].data.ptr;
+            if (s == NULL) {
+                // Accept every waiting connection
+                int fd;
+                while ((fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+                    Session *fresh = sessionAlloc();
+                    if (fresh == NULL) {
+                        close(fd);
+                        continue;
+                    }
+                    if (family == AF_INET) {
+                        int on = 1;
+                        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    }
+                    fresh->fd = fd;
+                    fresh->secret = nextSecret();
+                    fresh->attempts = fresh->inLength = fresh->outLength = fresh->closing = 0;
+                    fresh->events = EPOLLIN;
+                    struct epoll_event sev = {.events = EPOLLIN, .data.ptr = fresh};
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &sev);
+                }
+                continue;
+            }
+            int failed = 0;
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) failed = 1;
+            if (!failed && (events[i].events & EPOLLIN)) failed = handleReadable(s) < 0;
+            if (!failed) failed = serviceSession(epfd, s) < 0;
+            if (failed) closeSession(epfd, s);
+        }
+    }
+}
+
+/*
+    Load-generator client.
+    Every connection plays binary search with exactly one request in
+    flight and records the time from sending a guess to reading the reply.
+*/
+typedef struct {
+    int fd;
+    int low, high, guess;
+    int gamesLeft;
+    uint64_t sentAt;
+    char in[LINE_MAX_LENGTH];
+    int inLength;
+} Player;
+
+uint64_t nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int sendGuess(Player *p) {
+    char line[LINE_MAX_LENGTH];
+    p->guess = p->low + (p->high - p->low) / 2;
+    int n = snprintf(line, sizeof(line), "G %d\n", p->guess);
+    p->sentAt = nowNanos();
+    return write(p->fd, line, n) == n ? 0 : -1;   // Tiny writes fit in the socket buffer
+}
+
+int compareU64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+int runClient(const char *address, int connections, int games) {
+    struct sockaddr_storage storage;
+    int family;
+    socklen_t length = makeAddress(address, &storage, &family);
+
+    raiseFileLimit();
+    Player *players = (Player *)calloc(connections, sizeof(Player));
+    size_t maxSamples = (size_t)connections * games * 8;   // 1-100 needs at most 7 guesses
+    uint64_t *latency = (uint64_t *)malloc(maxSamples * sizeof(uint64_t));
+    if (players == NULL || latency == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    size_t samples = 0;
+    int epfd = epoll_create1(0);
+
+    uint64_t start = nowNanos();
+    for (int i = 0; i < connections; i++) {
+        Player *p = &players[i];
+        p->fd = socket(family, SOCK_STREAM, 0);
+        if (p->fd < 0 || connect(p->fd, (struct sockaddr *)&storage, length) < 0) {
+            perror("connect");
+            return 1;
+        }
+        if (family == AF_INET) {
+            int on = 1;
+            setsockopt(p->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        setNonBlocking(p->fd);
+        p->low = 1;
+        p->high = 100;
+        p->gamesLeft = games;
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = p};
+        epoll_ctl(epfd, EPOLL_CTL_ADD, p->fd, &ev);
+        sendGuess(p);
+    }
+    double connectSeconds = (nowNanos() - start) / 1e9;
+
+    int active = connections;
+    long gamesDone = 0;
+    struct epoll_event events[MAX_EVENTS];
+    while (active > 0) {
+        int ready = epoll_wait(epfd, events, MAX_EVENTS, 5000);
+        if (ready <= 0) {
+            fprintf(stderr, "Timed out waiting for the server.\n");
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            Player *p = (Player *)events[i].data.ptr;
+            ssize_t n = read(p->fd, p->in + p->inLength, sizeof(p->in) - p->inLength);
+            if (n <= 0) {
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+                close(p->fd);
+                active--;
+                continue;
+            }
+            p->inLength += (int)n;
+            char *newline = memchr(p->in, '\n', p->inLength);
+            if (newline == NULL) continue;   // Partial reply: wait for the rest
+            uint64_t now = nowNanos();
+            if (samples < maxSamples) latency[samples++] = now - p->sentAt;
+
+            if (strncmp(p->in, "LOW", 3) == 0) {
+                p->low = p->guess + 1;
+            } else if (strncmp(p->in, "HIGH", 4) == 0) {
+                p->high = p->guess - 1;
+            } else {
+                p->low = 1;
+                p->high = 100;
+                p->gamesLeft--;
+                gamesDone++;
+            }
+            p->inLength = 0;
+            if (p->gamesLeft > 0 && sendGuess(p) == 0) continue;
+            close(p->fd);
+            active--;
+        }
+    }
+    double seconds = (nowNanos() - start) / 1e9;
+
+    qsort(latency, samples, sizeof(uint64_t), compareU64);
+    printf("Connections: %d, games per connection: %d\n", connections, games);
+    printf("Connected in %.3f s, finished in %.3f s\n", connectSeconds, seconds);
+    printf("Requests: %zu (%.0f/s), games: %ld (%.0f/s)\n", samples, samples / seconds, gamesDone,
+           gamesDone / seconds);
+    printf("Sessions per second: %.0f\n", connections / seconds);
+    if (samples > 0) {
+        printf("Latency p50: %.1f us, p99: %.1f us, max: %.1f us\n", latency[samples / 2] / 1e3,
+               latency[samples * 99 / 100] / 1e3, latency[samples - 1] / 1e3);
+    }
+    free(players);
+    free(latency);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *mode = argc > 1 ? argv[1] : "bench";
+    const char *address = argc > 2 ? argv[2] : DEFAULT_ADDRESS;
+    int connections = argc > 3 ? atoi(argv[3]) : 10000;
+    int games = argc > 4 ? atoi(argv[4]) : 5;
+    signal(SIGPIPE, SIG_IGN);   // A closed socket gives EPIPE instead of killing us
+
+    if (strcmp(mode, "server") == 0) {
+        return runServer(address);
+    }
+    if (strcmp(mode, "client") == 0) {
+        return runClient(address, connections, games);
+    }
+    if (strcmp(mode, "bench") == 0) {
+        pid_t child = fork();
+        if (child == 0) {
+            freopen("/dev/null", "w", stdout);
+            return runServer(address);
+        }
+        usleep(200000);   // Give the server time to start listening
+        int status = runClient(address, connections, games);
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+        if (strncmp(address, "tcp:", 4) != 0) unlink(address);
+        return status;
+    }
+    fprintf(stderr, "Usage: %s server|client|bench [address] [connections] [games]\n", argv[0]);
+    return 1;
+}
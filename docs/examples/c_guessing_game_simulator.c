@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*
+    HEADLESS NUMBER GUESSING GAME SIMULATOR
+
+    Separating logic from I/O:
+    - In c_number_guessing_game.c the rules ("too low", "too high",
+      "correct") are mixed with printf() and scanf(), so the game can only
+      be played by a person at a keyboard.
+    - Here the rules live in gameCheck(), which only compares numbers.
+      The interactive mode (-i) and the simulator both call it.
+
+    Strategies:
+    - A strategy is a function that picks the next guess from the range
+      that is still possible: int strategy(low, high, max, rng).
+    - binary:        the middle of the range (at most ceil(log2(max+1))).
+    - random:        any number in the range.
+    - interpolation: the weighted median of the range under the secret
+                     distribution. With uniform secrets this is binary
+                     search; with skewed secrets it needs fewer guesses.
+
+    Simulation:
+    - Every thread gets its own xoshiro256++ stream, plays its share of
+      the games and fills its own histogram of attempts. The histograms
+      are added together at the end, so threads never share memory while
+      they run.
+    - The streams come from one seed: thread k uses the generator jumped
+      k times by 2^128 steps (see c_random.c), so they never overlap.
+
+    Usage:
+        simulator [-g games] [-t threads] [-n max] [-d uniform|skewed]
+        simulator -i        (play interactively)
+*/
+
+#define MAX_THREADS 64
+#define MAX_ATTEMPTS 64   // Histogram buckets; longer games go in the last one
+
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t rngNext(Rng *g) {
+    uint64_t *s = g->s;
+    uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+void rngSeed(Rng *g, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        g->s[i] = z ^ (z >> 31);
+    }
+}
+
+// Function to advance the generator by 2^128 steps (one independent stream, as in c_random.c)
+void rngJump(Rng *g) {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= g->s[0];
+                s1 ^= g->s[1];
+                s2 ^= g->s[2];
+                s3 ^= g->s[3];
+            }
+            rngNext(g);
+        }
+    }
+    g->s[0] = s0;
+    g->s[1] = s1;
+    g->s[2] = s2;
+    g->s[3] = s3;
+}
+
+// Function to pick a number in [low, high] without modulo bias (Lemire)
+int rngRange(Rng *g, int low, int high) {
+    uint32_t range = (uint32_t)(high - low + 1);
+    uint64_t m = (rngNext(g) >> 32) * range;
+    if ((uint32_t)m < range) {
+        uint32_t threshold = -range % range;
+        while ((uint32_t)m < threshold) m = (rngNext(g) >> 32) * range;
+    }
+    return low + (int)(m >> 32);
+}
+
+/*
+    Game logic (no I/O).
+*/
+
+// Function to check a guess: -1 too low, 1 too high, 0 correct
+int gameCheck(int secret, int guess) {
+    if (guess < secret) return -1;
+    if (guess > secret) return 1;
+    return 0;
+}
+
+/*
+    Secret distributions.
+    skewed: the smaller of two uniform numbers, so P(x) is proportional
+    to (max - x + 1) and small secrets are much more common.
+*/
+typedef enum { UNIFORM, SKEWED } Distribution;
+
+int drawSecret(Rng *g, int max, Distribution d) {
+    int a = rngRange(g, 1, max);
+    if (d == UNIFORM) return a;
+    int b = rngRange(g, 1, max);
+    return a < b ? a : b;
+}
+
+// Function giving the total weight of secrets 1..x (skewed distribution)
+static inline int64_t skewedWeight(int64_t x, int64_t max) {
+    return x * max - x * (x - 1) / 2;
+}
+
+/*
+    Strategies.
+*/
+typedef int (*Strategy)(int low, int high, int max, Distribution d, Rng *g);
+
+int binaryStrategy(int low, int high, int max, Distribution d, Rng *g) {
+    (void)max; (void)d; (void)g;
+    return low + (high - low) / 2;
+}
+
+int randomStrategy(int low, int high, int max, Distribution d, Rng *g) {
+    (void)max; (void)d;
+    return rngRange(g, low, high);
+}
+
+int interpolationStrategy(int low, int high, int max, Distribution d, Rng *g) {
+    (void)g;
+    if (d == UNIFORM) return low + (high - low) / 2;
+    // Smallest guess whose weight from low reaches half of the range's weight
+    int64_t base = skewedWeight(low - 1, max);
+    int64_t half = (skewedWeight(high, max) - base + 1) / 2;
+    int lo = low, hi = high;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (skewedWeight(mid, max) - base >= half) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+// Function to play one game headless; returns the number of attempts
+int playGame(int secret, int max, Distribution d, Strategy strategy, Rng *g) {
+    int low = 1, high = max, attempts = 0;
+    for (;;) {
+        int guess = strategy(low, high, max, d, g);
+        attempts++;
+        int result = gameCheck(secret, guess);
+        if (result == 0) return attempts;
+        if (result < 0) low = guess + 1;
+        else high = guess - 1;
+    }
+}
+
+/*
+    Parallel simulation.
+*/
+typedef struct {
+    Strategy strategy;
+    Distribution distribution;
+    int max;
+    long games;
+    Rng rng;
+    long histogram[MAX_ATTEMPTS + 1];
+} SimJob;
+
+void *simulate(void *arg) {
+    SimJob *job = (SimJob *)arg;
+    memset(job->histogram, 0, sizeof(job->histogram));
+    for (long i = 0; i < job->games; i++) {
+        int secret = drawSecret(&job->rng, job->max, job->distribution);
+        int attempts = playGame(secret, job->max, job->distribution, job->strategy, &job->rng);
+        job->histogram[attempts < MAX_ATTEMPTS ? attempts : MAX_ATTEMPTS]++;
+    }
+    return NULL;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to run one strategy on all threads and print its report
+void runStrategy(const char *name, Strategy strategy, long games, int threads, int max,
+                 Distribution d, uint64_t seed) {
+    SimJob jobs[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    Rng stream;
+    rngSeed(&stream, seed);
+    for (int i = 0; i < threads; i++) {
+        jobs[i].strategy = strategy;
+        jobs[i].distribution = d;
+        jobs[i].max = max;
+        jobs[i].games = games / threads + (i < games % threads ? 1 : 0);
+        jobs[i].rng = stream;   // Streams 2^128 steps apart never overlap
+        rngJump(&stream);
+    }
+    double start = nowSeconds();
+    for (int i = 0; i < threads; i++) pthread_create(&ids[i], NULL, simulate, &jobs[i]);
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    double elapsed = nowSeconds() - start;
+
+    long histogram[MAX_ATTEMPTS + 1] = {0};
+    for (int i = 0; i < threads; i++) {
+        for (int a = 0; a <= MAX_ATTEMPTS; a++) histogram[a] += jobs[i].histogram[a];
+    }
+    double total = 0;
+    int worst = 0;
+    for (int a = 1; a <= MAX_ATTEMPTS; a++) {
+        total += (double)a * histogram[a];
+        if (histogram[a] > 0) worst = a;
+    }
+
+    printf("\n%s: mean %.3f attempts, worst %d%s, %.1f million games/s\n", name, total / games,
+           worst, worst == MAX_ATTEMPTS ? "+" : "", games / elapsed / 1e6);
+    for (int a = 1; a <= worst; a++) {
+        if (histogram[a] == 0) continue;
+        double share = 100.0 * histogram[a] / games;
+        printf("  %2d%s %6.2f%% ", a, a == MAX_ATTEMPTS ? "+" : " ", share);
+        for (int bar = 0; bar < (int)(share / 2); bar++) putchar('#');
+        putchar('\n');
+    }
+}
+
+// Function to play the original interactive game on top of gameCheck()
+void playInteractive(int max) {
+    Rng rng;
+    rngSeed(&rng, (uint64_t)time(NULL));
+    int secret = rngRange(&rng, 1, max);
+    int guess, attempts = 0, result;
+
+    printf("I have selected a number between 1 and %d.\n", max);
+    do {
+        printf("Enter your guess: ");
+        if (scanf("%d", &guess) != 1) return;
+        attempts++;
+        result = gameCheck(secret, guess);
+        if (result < 0) printf("Too low! Try again.\n");
+        else if (result > 0) printf("Too high! Try again.\n");
+    } while (result != 0);
+    printf("Congratulations! You guessed the number in %d attempts.\n", attempts);
+}
+
+int main(int argc, char *argv[]) {
+    long games = 10000000;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max = 100;
+    Distribution d = UNIFORM;
+    int interactive = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:t:n:d:i")) != -1) {
+        switch (opt) {
+            case 'g': games = atol(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 'n': max = atoi(optarg); break;
+            case 'd': d = strcmp(optarg, "skewed") == 0 ? SKEWED : UNIFORM; break;
+            case 'i': interactive = 1; break;
+            default:
+                fprintf(stderr, "Usage: %s [-g games] [-t threads] [-n max] [-d uniform|skewed] [-i]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (max < 1 || games < 1) {
+        fprintf(stderr, "max and games must be positive.\n");
+        return 1;
+    }
+    if (interactive) {
+        playInteractive(max);
+        return 0;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    printf("Simulating %ld games per strategy, secrets 1-%d (%s), %d thread(s)\n", games, max,
+           d == UNIFORM ? "uniform" : "skewed", threads);
+    uint64_t seed = (uint64_t)time(NULL);
+    runStrategy("binary", binaryStrategy, games, threads, max, d, seed);
+    runStrategy("random", randomStrategy, games, threads, max, d, seed);
+    runStrategy("interpolation", interpolationStrategy, games, threads, max, d, seed);
+
+    return 0;
+}
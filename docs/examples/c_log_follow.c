@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <libgen.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+/*
+    FOLLOWING A GROWING LOG FILE
+
+    The Problem:
+    - The character, line and word counters in c_text_processing_examples.c
+      read source.txt from the beginning every time. For a log that is being
+      written, counting again after every append costs work proportional to
+      the whole file.
+
+    Incremental Counting:
+    - The counts, the "inside a word" flag and the file offset are kept
+      between reads. New bytes are counted where the last read stopped, so
+      the work is proportional to the new data only. A word split across
+      two appends is still counted once, because inWord carries over.
+
+    Waiting With inotify:
+    - Instead of polling, the program asks the kernel to report changes:
+      a watch on the file reports writes (IN_MODIFY), and a watch on its
+      directory reports a new file with the same name (rotation).
+
+    Truncation and Rotation:
+    - Truncated ("copytruncate" rotation, or "> file"): the file is now
+      shorter than the offset. Counting restarts at offset 0.
+    - Rotated (renamed or deleted, and a new file created): the new file is
+      counted from offset 0. The old file stays open until the next
+      rotation, because the writer may still append to it for a while.
+    - The counts are totals over everything the log received while it was
+      followed, across truncations and rotations.
+
+    Usage:
+        log_follow [-n] [-t idle-seconds] FILE
+        -n  count only data written from now on (like tail -f -n 0)
+        -t  stop after this many seconds without changes
+*/
+
+#define BUFFER_SIZE 65536
+
+typedef struct {
+    uint64_t chars, lines, words;
+} Counts;
+
+typedef struct {
+    int fd;                    // -1 if not open
+    int watch;                 // inotify watch on the file, -1 if none
+    dev_t device;
+    ino_t inode;
+    off_t offset;              // Everything before this has been counted
+    int inWord;                // Word state at the offset
+} OpenFile;
+
+typedef struct {
+    const char *path;
+    OpenFile current;          // The file now at 'path'
+    OpenFile previous;         // The file before the last rotation, still drained
+} Followed;
+
+static const unsigned char separators[256] = {[' '] = 1, ['\n'] = 1, ['\t'] = 1};
+
+// Function to add n bytes to the counts, continuing the word state of the previous call
+void countBytes(Counts *c, int *inWordState, const unsigned char *p, size_t n) {
+    uint64_t lines = 0, words = 0;
+    int inWord = *inWordState;
+    for (size_t i = 0; i < n; i++) {
+        int separator = separators[p[i]];
+        lines += p[i] == '\n';
+        words += !separator & !inWord;
+        inWord = !separator;
+    }
+    c->chars += n;
+    c->lines += lines;
+    c->words += words;
+    *inWordState = inWord;
+}
+
+// Function to count everything from the offset to the current end of the file; returns 0, or -1 on a read error
+int readNew(OpenFile *f, Counts *c) {
+    static unsigned char buffer[BUFFER_SIZE];
+    if (f->fd < 0) return 0;
+    for (;;) {
+        ssize_t n = pread(f->fd, buffer, BUFFER_SIZE, f->offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return 0;
+        countBytes(c, &f->inWord, buffer, n);
+        f->offset += n;
+    }
+}
+
+// Function to detect a truncated file; counting then restarts at offset 0, because the old content is gone
+int checkTruncated(OpenFile *f) {
+    struct stat st;
+    if (f->fd < 0 || fstat(f->fd, &st) != 0 || st.st_size >= f->offset) return 0;
+    f->offset = 0;
+    f->inWord = 0;
+    return 1;
+}
+
+// Function to open the file at 'path' (if it exists) and watch it; returns 1 if opened
+int openFile(OpenFile *f, const char *path, int inotifyFd) {
+    f->fd = open(path, O_RDONLY);
+    if (f->fd < 0) return 0;
+    struct stat st;
+    fstat(f->fd, &st);
+    f->device = st.st_dev;
+    f->inode = st.st_ino;
+    f->offset = 0;
+    f->inWord = 0;
+    f->watch = inotify_add_watch(inotifyFd, path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+    return 1;
+}
+
+void closeFile(OpenFile *f, int inotifyFd) {
+    if (f->watch >= 0) inotify_rm_watch(inotifyFd, f->watch);
+    if (f->fd >= 0) close(f->fd);
+    f->fd = -1;
+    f->watch = -1;
+}
+
+// Function to check the followed files after any event; returns a short description of what happened
+const char *checkFiles(Followed *f, Counts *c, int inotifyFd) {
+    const char *what = NULL;
+    // A writer may still append to the rotated file until it reopens the log
+    checkTruncated(&f->previous);
+    if (readNew(&f->previous, c) != 0) return "read error";
+    if (f->current.fd >= 0) {
+        if (checkTruncated(&f->current)) what = "truncated";
+        if (readNew(&f->current, c) != 0) return "read error";
+        struct stat named;
+        int replaced = stat(f->path, &named) != 0 || named.st_ino != f->current.inode ||
+                       named.st_dev != f->current.device;
+        if (!replaced) return what;
+        // Rotated: keep draining the old file, and look for a new one
+        closeFile(&f->previous, inotifyFd);
+        f->previous = f->current;
+        f->current.fd = -1;
+        f->current.watch = -1;
+        what = "rotated";
+    }
+    if (openFile(&f->current, f->path, inotifyFd)) {
+        if (readNew(&f->current, c) != 0) return "read error";
+        if (what == NULL) what = "created";
+    }
+    return what;
+}
+
+void printCounts(const Counts *c, const char *event) {
+    printf("lines %10llu  words %10llu  chars %12llu%s%s\n", (unsigned long long)c->lines,
+           (unsigned long long)c->words, (unsigned long long)c->chars,
+           event ? "  | " : "", event ? event : "");
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    int onlyNew = 0, idleSeconds = -1, opt;
+    while ((opt = getopt(argc, argv, "nt:")) != -1) {
+        if (opt == 'n') {
+            onlyNew = 1;
+        } else if (opt == 't') {
+            idleSeconds = atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-n] [-t idle-seconds] FILE\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-n] [-t idle-seconds] FILE\n", argv[0]);
+        return 2;
+    }
+
+    int inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        perror("inotify_init1");
+        return 1;
+    }
+    // Watch the directory for a file of the same name appearing (rotation or late creation)
+    char pathCopy[PATH_MAX];
+    snprintf(pathCopy, sizeof(pathCopy), "%s", argv[optind]);
+    const char *directory = dirname(pathCopy);
+    char nameCopy[PATH_MAX];
+    snprintf(nameCopy, sizeof(nameCopy), "%s", argv[optind]);
+    const char *name = basename(nameCopy);
+    int directoryWatch = inotify_add_watch(inotifyFd, directory, IN_CREATE | IN_MOVED_TO);
+    if (directoryWatch < 0) {
+        perror(directory);
+        return 1;
+    }
+
+    Followed f = {argv[optind], {-1, -1, 0, 0, 0, 0}, {-1, -1, 0, 0, 0, 0}};
+    Counts counts = {0, 0, 0};
+    if (openFile(&f.current, f.path, inotifyFd)) {
+        if (onlyNew) {
+            f.current.offset = lseek(f.current.fd, 0, SEEK_END);
+        } else if (readNew(&f.current, &counts) != 0) {
+            perror(f.path);
+            return 1;
+        }
+        printCounts(&counts, onlyNew ? "following new data" : "initial scan");
+    } else {
+        printCounts(&counts, "waiting for the file");
+    }
+
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfd = {inotifyFd, POLLIN, 0};
+    for (;;) {
+        int ready = poll(&pfd, 1, idleSeconds >= 0 ? idleSeconds * 1000 : -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return 1;
+        }
+        if (ready == 0) break;    // Idle timeout
+        ssize_t n = read(inotifyFd, events, sizeof(events));
+        if (n <= 0) continue;
+
+        // Many events may arrive at once; one check after the batch handles them all
+        int relevant = 0;
+        for (char *p = events; p < events + n;) {
+            struct inotify_event *e = (struct inotify_event *)p;
+            if (e->wd != directoryWatch || (e->len > 0 && strcmp(e->name, name) == 0)) relevant = 1;
+            p += sizeof(struct inotify_event) + e->len;
+        }
+        if (!relevant) continue;
+        uint64_t before = counts.chars;
+        const char *event = checkFiles(&f, &counts, inotifyFd);
+        if (counts.chars != before || event != NULL) printCounts(&counts, event);
+    }
+    printCounts(&counts, "idle, stopping");
+    closeFile(&f.current, inotifyFd);
+    closeFile(&f.previous, inotifyFd);
+    close(inotifyFd);
+    return 0;
+}
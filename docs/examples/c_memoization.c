@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+    LOOKUP TABLES AND MEMOIZATION
+
+    Pure functions:
+    - A pure function's result depends only on its arguments (no globals,
+      no I/O). factorial(5) is always 120, so it can be computed once and
+      looked up afterwards.
+
+    Tables built by the compiler:
+    - C has no constexpr functions, but any expression made only of
+      constants is computed by the compiler. AREA(r) with a literal r is
+      such an expression.
+    - TABLE_64(F, 0) expands to F(0) F(1) ... F(63), so a whole table of
+      circle areas becomes constants in the program file; nothing runs at
+      startup.
+
+    Tables built by a generator step:
+    - Recursive functions such as factorial cannot be written as one
+      constant expression. Instead, this program can print the table as C
+      source (--generate), and the next build #includes that file.
+    - If the generated header is missing, the same table is filled once
+      at run time, guarded by pthread_once so threads can share it.
+
+    Runtime memoization (large domains):
+    - collatzSteps(n) is pure, but n can be any 64-bit number, far too many
+      for a table. A fixed-size cache remembers recent results instead.
+    - The cache has no locks. Each slot stores (key XOR value) and value as
+      two relaxed atomics. If two threads write a slot at the same time, a
+      reader may see one word from each write; then (key XOR value) XOR
+      value no longer equals the key, and the read counts as a miss. A miss
+      only costs a recomputation, because the function is pure.
+*/
+
+#define PI 3.14159265358979323846
+#define MAX_RADIUS 63
+#define FACTORIAL_MAX 20            // 21! does not fit in 64 bits
+#define CACHE_BITS 20               // About 1 million slots (16 MB)
+
+/* ---------- A table computed by the compiler ---------- */
+
+#define AREA(r) (PI * (r) * (r)),
+#define TABLE_4(F, n) F(n) F((n) + 1) F((n) + 2) F((n) + 3)
+#define TABLE_16(F, n) TABLE_4(F, n) TABLE_4(F, (n) + 4) TABLE_4(F, (n) + 8) TABLE_4(F, (n) + 12)
+#define TABLE_64(F, n) TABLE_16(F, n) TABLE_16(F, (n) + 16) TABLE_16(F, (n) + 32) TABLE_16(F, (n) + 48)
+
+const double circleAreas[] = { TABLE_64(AREA, 0) };
+
+_Static_assert(sizeof(circleAreas) / sizeof(circleAreas[0]) == MAX_RADIUS + 1, "one area per radius");
+
+/* ---------- A table from a generator step ---------- */
+
+// The original recursive version
+int factorial(int n) {
+    if (n <= 1) return 1;
+    else return n * factorial(n - 1);
+}
+
+uint64_t factorial64(int n) {
+    return n <= 1 ? 1 : n * factorial64(n - 1);
+}
+
+#if defined(__has_include)
+#if __has_include("memo_tables.h")
+#include "memo_tables.h"            // Defines factorialTable[] and GENERATED_TABLES
+#endif
+#endif
+
+#ifndef GENERATED_TABLES
+uint64_t factorialTable[FACTORIAL_MAX + 1];
+pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+void fillTables(void) {
+    for (int n = 0; n <= FACTORIAL_MAX; n++) factorialTable[n] = factorial64(n);
+}
+#endif
+
+// Function to make sure the tables are ready (does nothing when they were generated)
+static inline void initTables(void) {
+#ifndef GENERATED_TABLES
+    pthread_once(&tablesOnce, fillTables);
+#endif
+}
+
+// Function to print the tables as C source, for: ./memoization --generate > memo_tables.h
+void generateTables(FILE *out) {
+    fprintf(out, "// Generated by memoization --generate. Do not edit.\n");
+    fprintf(out, "#define GENERATED_TABLES 1\n\n");
+    fprintf(out, "const uint64_t factorialTable[%d] = {\n", FACTORIAL_MAX + 1);
+    for (int n = 0; n <= FACTORIAL_MAX; n++) {
+        fprintf(out, "    %lluULL,   // %d!\n", (unsigned long long)factorial64(n), n);
+    }
+    fprintf(out, "};\n");
+}
+
+static inline uint64_t factorialLookup(int n) {
+    return factorialTable[n];
+}
+
+/* ---------- A thread-safe memoization cache ---------- */
+
+typedef struct {
+    _Atomic uint64_t check;    // key XOR value
+    _Atomic uint64_t value;
+} CacheSlot;
+
+typedef struct {
+    CacheSlot slots[1 << CACHE_BITS];
+} MemoCache;
+
+static inline size_t slotIndex(uint64_t key) {
+    return (size_t)((key * 0x9e3779b97f4a7c15ULL) >> (64 - CACHE_BITS));    // Fibonacci hashing
+}
+
+// Function to look up key (never 0); returns 1 and sets *value on a hit
+static inline int cacheGet(MemoCache *cache, uint64_t key, uint64_t *value) {
+    CacheSlot *slot = &cache->slots[slotIndex(key)];
+    uint64_t check = atomic_load_explicit(&slot->check, memory_order_relaxed);
+    uint64_t v = atomic_load_explicit(&slot->value, memory_order_relaxed);
+    if ((check ^ v) != key) return 0;    // Empty, another key, or a torn write
+    *value = v;
+    return 1;
+}
+
+static inline void cachePut(MemoCache *cache, uint64_t key, uint64_t value) {
+    CacheSlot *slot = &cache->slots[slotIndex(key)];
+    atomic_store_explicit(&slot->check, key ^ value, memory_order_relaxed);
+    atomic_store_explicit(&slot->value, value, memory_order_relaxed);
+}
+
+// Number of Collatz steps (n -> n/2 or 3n+1) until n reaches 1
+uint64_t collatzSteps(uint64_t n) {
+    uint64_t steps = 0;
+    while (n != 1) {
+        n = n % 2 == 0 ? n / 2 : 3 * n + 1;
+        steps++;
+    }
+    return steps;
+}
+
+// The same function, memoized: every number on the path is looked up first
+uint64_t collatzMemo(MemoCache *cache, uint64_t n) {
+    if (n == 1) return 0;
+    uint64_t steps;
+    if (cacheGet(cache, n, &steps)) return steps;
+    steps = 1 + collatzMemo(cache, n % 2 == 0 ? n / 2 : 3 * n + 1);
+    cachePut(cache, n, steps);
+    return steps;
+}
+
+/* ---------- Benchmarks ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define THREADS 4
+
+typedef struct {
+    MemoCache *cache;      // NULL: compute directly
+    uint64_t first;
+    uint64_t count;
+    uint64_t sum;
+} CollatzJob;
+
+void *collatzWorker(void *arg) {
+    CollatzJob *job = (CollatzJob *)arg;
+    uint64_t sum = 0;
+    for (uint64_t n = job->first; n < job->first + job->count; n++) {
+        sum += job->cache != NULL ? collatzMemo(job->cache, n) : collatzSteps(n);
+    }
+    job->sum = sum;
+    return NULL;
+}
+
+// Function to sum collatzSteps(1..count) on THREADS threads; returns seconds
+double runCollatz(MemoCache *cache, uint64_t count, uint64_t *sum) {
+    pthread_t ids[THREADS];
+    CollatzJob jobs[THREADS];
+    double start = nowSeconds();
+    for (int t = 0; t < THREADS; t++) {
+        // Each thread takes one range of numbers; all of them share the cache
+        jobs[t] = (CollatzJob){cache, 1 + t * (count / THREADS), count / THREADS, 0};
+        pthread_create(&ids[t], NULL, collatzWorker, &jobs[t]);
+    }
+    *sum = 0;
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(ids[t], NULL);
+        *sum += jobs[t].sum;
+    }
+    return nowSeconds() - start;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        generateTables(stdout);
+        return 0;
+    }
+    initTables();
+#ifdef GENERATED_TABLES
+    printf("Factorial table: generated at build time (memo_tables.h)\n");
+#else
+    printf("Factorial table: filled at startup (run --generate > memo_tables.h and rebuild to embed it)\n");
+#endif
+    printf("Area of a circle with radius 5: %.2f (table) = %.2f (formula)\n", circleAreas[5], PI * 5 * 5);
+    printf("20! = %llu\n\n", (unsigned long long)factorialLookup(20));
+
+    // Recursion versus table lookup; the volatile index keeps the compiler from precomputing
+    long calls = 100000000;
+    volatile int index = 12;
+    uint64_t sum = 0;
+    double start = nowSeconds();
+    for (long i = 0; i < calls; i++) sum += factorial(index - (int)(i & 7));
+    double recursiveTime = nowSeconds() - start;
+    uint64_t check = sum;
+    sum = 0;
+    start = nowSeconds();
+    for (long i = 0; i < calls; i++) sum += factorialLookup(index - (int)(i & 7));
+    double tableTime = nowSeconds() - start;
+    printf("factorial(5..12), %ld calls:\n", calls);
+    printf("  recursive:    %.2f ns per call\n", recursiveTime * 1e9 / calls);
+    printf("  table lookup: %.2f ns per call (%s)\n\n", tableTime * 1e9 / calls, sum == check ? "same results" : "MISMATCH");
+
+    // Collatz steps for 1..count on several threads, with and without the shared cache
+    uint64_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000;
+    MemoCache *cache = calloc(1, sizeof(MemoCache));
+    if (cache == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    uint64_t directSum, memoSum;
+    double directTime = runCollatz(NULL, count, &directSum);
+    double memoTime = runCollatz(cache, count, &memoSum);
+    printf("Collatz steps for 1..%llu on %d threads:\n", (unsigned long long)(count / THREADS * THREADS), THREADS);
+    printf("  computed:  %.3f s\n", directTime);
+    printf("  memoized:  %.3f s (%zu KB cache)\n", memoTime, sizeof(MemoCache) >> 10);
+    printf("  Results match: %s\n", directSum == memoSum ? "yes" : "no");
+
+    free(cache);
+    return 0;
+}
@@ -0,0 +1,554 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+
+/*
+    PERSISTENT MEMORY-MAPPED HASH TABLE
+
+    The Idea:
+    - The table lives in a file, in exactly the layout it has in memory.
+      Opening it is one mmap() call: there is nothing to parse or rebuild,
+      and pages are loaded from disk only when a lookup touches them.
+
+    The File:
+        page 0      header: magic, sizes, where the table is, generation
+        table       capacity x 64-byte slots (open addressing, linear probing)
+    - A slot holds the key's hash (0 = empty), a 64-bit value and the key
+      itself (up to 44 bytes). One slot is one cache line.
+
+    Growing:
+    - At 70% load, the file is extended with ftruncate(), the mapping is
+      enlarged with mremap(), and the keys are rehashed into a new table
+      after the old one. The header then points to the new table, and the
+      disk space of the old one is given back (a "hole" is punched).
+
+    One Writer, Many Readers:
+    - The writer holds an exclusive flock(); readers map the file read-only
+      from any number of processes, without locks.
+    - A new key becomes visible with one atomic store of its hash, after the
+      key and value are written. Values are 64-bit atomic stores, so a
+      reader never sees half of an update.
+    - The header's generation number is odd while the table is moving. A
+      reader that sees the generation change during a lookup simply
+      repeats it (a "seqlock").
+    - A writer that dies while growing leaves an odd generation, and maybe
+      a header that points to the new table but still has the old size.
+      The next writer repairs the header when it opens the file. Until
+      then, readers that find no writer holding the lock report an error
+      instead of waiting forever.
+
+    Usage:
+        mmap_hash_table FILE count TEXTFILE    add the words of a text file
+        mmap_hash_table FILE get KEY...
+        mmap_hash_table FILE top               show the table statistics
+        mmap_hash_table FILE bench N           build, reopen and look up N keys
+        mmap_hash_table FILE stress N          writer and reader processes at once
+*/
+
+#define KEY_MAX 44
+#define PAGE 4096
+#define INITIAL_CAPACITY 1024
+#define MAX_LOAD_PERCENT 70
+
+typedef struct {
+    _Atomic uint64_t hash;     // 0 marks an empty slot
+    _Atomic uint64_t value;
+    uint32_t keyLength;
+    char key[KEY_MAX];
+} Slot;
+
+typedef struct {
+    char magic[8];
+    uint32_t slotSize;
+    uint32_t keyMax;
+    _Atomic uint64_t generation;   // Odd while the table is being replaced
+    _Atomic uint64_t tableOffset;
+    _Atomic uint64_t capacity;     // Power of two
+    _Atomic uint64_t count;
+    _Atomic uint64_t fileSize;
+} Header;
+
+typedef struct {
+    int fd;
+    int writable;
+    uint8_t *map;
+    size_t mapSize;
+} MappedTable;
+
+_Static_assert(sizeof(Slot) == 64, "a slot must be one cache line");
+_Static_assert(sizeof(Header) <= PAGE, "the header must fit in the first page");
+
+static inline Header *tableHeader(const MappedTable *t) {
+    return (Header *)t->map;
+}
+
+static inline Slot *tableSlots(const MappedTable *t) {
+    return (Slot *)(t->map + atomic_load_explicit(&tableHeader(t)->tableOffset, memory_order_acquire));
+}
+
+// Function to hash a key, 8 bytes at a time; never returns 0, which marks empty slots
+uint64_t hashKey(const char *key, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, key, 8);
+        h = (h ^ v) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 29;
+        key += 8;
+        n -= 8;
+    }
+    if (n > 0) {
+        uint64_t v = 0;
+        memcpy(&v, key, n);
+        h = (h ^ v) * 0xbf58476d1ce4e5b9ULL;
+    }
+    h ^= h >> 32;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 29;
+    return h != 0 ? h : 1;
+}
+
+/* ---------- Opening ---------- */
+
+// Function to (re)map the whole file; readers call it when the file has grown
+int mapWholeFile(MappedTable *t) {
+    struct stat st;
+    if (fstat(t->fd, &st) != 0) return -1;
+    if (t->map != NULL && (size_t)st.st_size == t->mapSize) return 0;
+    if (t->map != NULL) munmap(t->map, t->mapSize);
+    t->map = mmap(NULL, st.st_size, t->writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, t->fd, 0);
+    if (t->map == MAP_FAILED) {
+        t->map = NULL;
+        return -1;
+    }
+    t->mapSize = st.st_size;
+    return 0;
+}
+
+// Function to finish or undo a growth that a dead writer left behind (the caller holds the writer lock)
+int tableRepair(MappedTable *t) {
+    Header *h = tableHeader(t);
+    uint64_t offset = atomic_load(&h->tableOffset), fileSize = atomic_load(&h->fileSize);
+    if (atomic_load(&h->generation) & 1) {
+        if (offset >= fileSize) {
+            // The new table was published, its size maybe not: it ends where the file ends
+            uint64_t capacity = (t->mapSize - offset) / sizeof(Slot);
+            if (offset >= t->mapSize || (capacity & (capacity - 1)) != 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            atomic_store(&h->capacity, capacity);
+            atomic_store(&h->fileSize, t->mapSize);
+            fileSize = t->mapSize;
+        }
+        atomic_fetch_add(&h->generation, 1);
+    }
+    if (t->mapSize > fileSize) {
+        // Space for a new table that was never published: drop it, so the next growth starts from zeros
+        if (ftruncate(t->fd, fileSize) != 0 || mapWholeFile(t) != 0) return -1;
+    }
+    return 0;
+}
+
+// Function to tell whether a writer holds the table open
+int writerAlive(MappedTable *t) {
+    if (flock(t->fd, LOCK_SH | LOCK_NB) != 0) return 1;
+    flock(t->fd, LOCK_UN);
+    return 0;
+}
+
+// Function to open a table file; a writer creates it if needed and locks it against other writers
+int tableOpen(MappedTable *t, const char *path, int writable) {
+    memset(t, 0, sizeof(*t));
+    t->writable = writable;
+    t->fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (t->fd < 0) return -1;
+    if (writable && flock(t->fd, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "%s: another writer has the table open\n", path);
+        close(t->fd);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(t->fd, &st) != 0) return -1;
+    if (st.st_size == 0) {
+        if (!writable) {
+            errno = ENOENT;
+            return -1;
+        }
+        // New file: header page plus the first table
+        size_t size = PAGE + (size_t)INITIAL_CAPACITY * sizeof(Slot);
+        if (ftruncate(t->fd, size) != 0 || mapWholeFile(t) != 0) return -1;
+        Header *h = tableHeader(t);
+        memcpy(h->magic, "MHTABLE1", 8);
+        h->slotSize = sizeof(Slot);
+        h->keyMax = KEY_MAX;
+        atomic_store(&h->tableOffset, PAGE);
+        atomic_store(&h->capacity, INITIAL_CAPACITY);
+        atomic_store(&h->count, 0);
+        atomic_store(&h->fileSize, size);
+        atomic_store(&h->generation, 0);
+        return 0;
+    }
+    if (mapWholeFile(t) != 0) return -1;
+    Header *h = tableHeader(t);
+    if (t->mapSize < PAGE || memcmp(h->magic, "MHTABLE1", 8) != 0 || h->slotSize != sizeof(Slot) || h->keyMax != KEY_MAX) {
+        fprintf(stderr, "%s: not a table file of this format\n", path);
+        errno = EINVAL;
+        return -1;
+    }
+    if (writable && tableRepair(t) != 0) {
+        fprintf(stderr, "%s: cannot repair an interrupted growth\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void tableClose(MappedTable *t) {
+    if (t->map != NULL) munmap(t->map, t->mapSize);
+    close(t->fd);
+}
+
+/* ---------- Lookups (any process) ---------- */
+
+// Function to find a key; returns 1 and sets *value if found, 0 if not, -1 on error
+int tableGet(MappedTable *t, const char *key, size_t n, uint64_t *value) {
+    if (n > KEY_MAX) return 0;
+    uint64_t hash = hashKey(key, n);
+    for (unsigned spins = 1;; spins++) {
+        Header *h = tableHeader(t);
+        uint64_t generation = atomic_load_explicit(&h->generation, memory_order_acquire);
+        if (generation & 1) {
+            // The writer is replacing the table. If no writer is left, only a new one can finish it.
+            if (spins % 1024 == 0 && !writerAlive(t) && (atomic_load(&h->generation) & 1)) {
+                errno = EAGAIN;
+                return -1;
+            }
+            sched_yield();
+            continue;
+        }
+        uint64_t offset = atomic_load_explicit(&h->tableOffset, memory_order_acquire);
+        uint64_t capacity = atomic_load_explicit(&h->capacity, memory_order_acquire);
+        if (offset + capacity * sizeof(Slot) > t->mapSize) {
+            // The table moved beyond our mapping: map the grown file
+            if (mapWholeFile(t) != 0) return -1;
+            continue;
+        }
+        Slot *slots = (Slot *)(t->map + offset);
+        int found = 0;
+        for (uint64_t i = hash & (capacity - 1);; i = (i + 1) & (capacity - 1)) {
+            uint64_t slotHash = atomic_load_explicit(&slots[i].hash, memory_order_acquire);
+            if (slotHash == 0) break;
+            if (slotHash == hash && slots[i].keyLength == n && memcmp(slots[i].key, key, n) == 0) {
+                *value = atomic_load_explicit(&slots[i].value, memory_order_acquire);
+                found = 1;
+                break;
+            }
+        }
+        // If the table moved meanwhile, what we read may be from the old one: look again
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&h->generation, memory_order_relaxed) == generation) return found;
+    }
+}
+
+/* ---------- Updates (the writer) ---------- */
+
+// Function to find the slot for a key in a table, or the empty slot where it belongs
+static Slot *findSlot(Slot *slots, uint64_t capacity, uint64_t hash, const char *key, size_t n) {
+    for (uint64_t i = hash & (capacity - 1);; i = (i + 1) & (capacity - 1)) {
+        uint64_t slotHash = atomic_load_explicit(&slots[i].hash, memory_order_relaxed);
+        if (slotHash == 0) return &slots[i];
+        if (slotHash == hash && slots[i].keyLength == n && memcmp(slots[i].key, key, n) == 0) return &slots[i];
+    }
+}
+
+// Function to double the table: extend the file, rehash into the new space, switch, free the old space
+int tableGrow(MappedTable *t) {
+    Header *h = tableHeader(t);
+    uint64_t oldOffset = atomic_load(&h->tableOffset), oldCapacity = atomic_load(&h->capacity);
+    uint64_t newOffset = atomic_load(&h->fileSize), newCapacity = oldCapacity * 2;
+    size_t newSize = newOffset + newCapacity * sizeof(Slot);
+    if (ftruncate(t->fd, newSize) != 0) return -1;
+    void *map = mremap(t->map, t->mapSize, newSize, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED) return -1;
+    t->map = map;
+    t->mapSize = newSize;
+    h = tableHeader(t);
+
+    // The new space reads as zeros (all slots empty); readers do not look at it yet
+    Slot *oldSlots = (Slot *)(t->map + oldOffset), *newSlots = (Slot *)(t->map + newOffset);
+    for (uint64_t i = 0; i < oldCapacity; i++) {
+        uint64_t hash = atomic_load_explicit(&oldSlots[i].hash, memory_order_relaxed);
+        if (hash == 0) continue;
+        Slot *s = findSlot(newSlots, newCapacity, hash, oldSlots[i].key, oldSlots[i].keyLength);
+        s->keyLength = oldSlots[i].keyLength;
+        memcpy(s->key, oldSlots[i].key, s->keyLength);
+        atomic_store_explicit(&s->value, atomic_load_explicit(&oldSlots[i].value, memory_order_relaxed), memory_order_relaxed);
+        atomic_store_explicit(&s->hash, hash, memory_order_relaxed);
+    }
+
+    // Switch tables inside an odd generation, so readers retry instead of mixing the two
+    atomic_fetch_add_explicit(&h->generation, 1, memory_order_acq_rel);
+    atomic_store_explicit(&h->tableOffset, newOffset, memory_order_release);
+    atomic_store_explicit(&h->capacity, newCapacity, memory_order_release);
+    atomic_store_explicit(&h->fileSize, newSize, memory_order_release);
+    atomic_fetch_add_explicit(&h->generation, 1, memory_order_acq_rel);
+
+    // Give the old table's disk space back; the file keeps its size, the range becomes a hole
+    fallocate(t->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, oldOffset, oldCapacity * sizeof(Slot));
+    return 0;
+}
+
+// Function to add delta to a key's value (creating it with value delta); returns 0, or -1 on error
+int tableAdd(MappedTable *t, const char *key, size_t n, uint64_t delta) {
+    if (n > KEY_MAX) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    uint64_t hash = hashKey(key, n);
+    Header *h = tableHeader(t);
+    Slot *s = findSlot(tableSlots(t), atomic_load(&h->capacity), hash, key, n);
+    if (atomic_load_explicit(&s->hash, memory_order_relaxed) != 0) {
+        // Existing key: one atomic store, readers see the old or the new value
+        uint64_t v = atomic_load_explicit(&s->value, memory_order_relaxed);
+        atomic_store_explicit(&s->value, v + delta, memory_order_release);
+        return 0;
+    }
+    if ((atomic_load(&h->count) + 1) * 100 > atomic_load(&h->capacity) * MAX_LOAD_PERCENT) {
+        if (tableGrow(t) != 0) return -1;
+        return tableAdd(t, key, n, delta);
+    }
+    // New key: fill the slot, then publish it by storing the hash last
+    s->keyLength = (uint32_t)n;
+    memcpy(s->key, key, n);
+    atomic_store_explicit(&s->value, delta, memory_order_relaxed);
+    atomic_store_explicit(&s->hash, hash, memory_order_release);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    return 0;
+}
+
+/* ---------- Commands ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to add every word of a text file (space, tab and newline separate words)
+int countWords(MappedTable *t, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    char word[KEY_MAX + 1];
+    size_t length = 0;
+    unsigned long long words = 0, skipped = 0;
+    int ch;
+    do {
+        ch = fgetc(file);
+        if (ch == EOF || ch == ' ' || ch == '\n' || ch == '\t') {
+            if (length > KEY_MAX) {
+                skipped++;
+            } else if (length > 0) {
+                if (tableAdd(t, word, length, 1) != 0) {
+                    perror("tableAdd");
+                    fclose(file);
+                    return 1;
+                }
+                words++;
+            }
+            length = 0;
+        } else {
+            if (length < KEY_MAX) word[length] = (char)ch;
+            length++;
+        }
+    } while (ch != EOF);
+    fclose(file);
+    printf("Added %llu words (%llu longer than %d bytes skipped); table has %llu keys\n",
+           words, skipped, KEY_MAX, (unsigned long long)atomic_load(&tableHeader(t)->count));
+    return 0;
+}
+
+void printStats(MappedTable *t) {
+    Header *h = tableHeader(t);
+    uint64_t count = atomic_load(&h->count), capacity = atomic_load(&h->capacity);
+    struct stat st;
+    fstat(t->fd, &st);
+    printf("Keys: %llu, capacity: %llu (%.0f%% full), generation %llu\n", (unsigned long long)count,
+           (unsigned long long)capacity, 100.0 * count / capacity, (unsigned long long)atomic_load(&h->generation));
+    printf("File size: %.1f MB, on disk: %.1f MB (old tables are punched out)\n",
+           st.st_size / 1048576.0, st.st_blocks * 512 / 1048576.0);
+}
+
+// Function to compare building a table with reopening it
+int benchmark(const char *path, long n) {
+    unlink(path);
+    MappedTable t;
+    char key[32];
+    double start = nowSeconds();
+    if (tableOpen(&t, path, 1) != 0) {
+        perror(path);
+        return 1;
+    }
+    for (long i = 0; i < n; i++) {
+        int len = sprintf(key, "key-%ld", i);
+        if (tableAdd(&t, key, len, (uint64_t)i * 7) != 0) {
+            perror("tableAdd");
+            return 1;
+        }
+    }
+    double build = nowSeconds() - start;
+    printStats(&t);
+    tableClose(&t);
+
+    start = nowSeconds();
+    if (tableOpen(&t, path, 0) != 0) {
+        perror(path);
+        return 1;
+    }
+    uint64_t value = 0;
+    int found = tableGet(&t, "key-12345", 9, &value);
+    double reopen = nowSeconds() - start;
+
+    // Prepare random keys first, so only the lookups are timed; half of them do not exist
+    long lookups = 1000000, hits = 0, correct = 0;
+    char (*keys)[24] = malloc(lookups * sizeof(*keys));
+    long *numbers = malloc(lookups * sizeof(long));
+    if (keys == NULL || numbers == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (long i = 0; i < lookups; i++) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        numbers[i] = state % (n * 2);
+        sprintf(keys[i], "key-%ld", numbers[i]);
+    }
+    // The first pass pays a page fault for each page it touches first; the second does not
+    double lookup[2];
+    for (int pass = 0; pass < 2; pass++) {
+        start = nowSeconds();
+        for (long i = 0; i < lookups; i++) {
+            uint64_t v;
+            if (tableGet(&t, keys[i], strlen(keys[i]), &v) == 1) {
+                hits++;
+                correct += v == (uint64_t)numbers[i] * 7;
+            }
+        }
+        lookup[pass] = nowSeconds() - start;
+    }
+    tableClose(&t);
+    free(keys);
+    free(numbers);
+
+    printf("Build %ld keys:          %8.3f s\n", n, build);
+    printf("Reopen + first lookup:  %8.3f ms (found: %s)\n", reopen * 1e3, found == 1 && value == 12345 * 7 ? "yes" : "no");
+    printf("Lookups, first pass:    %8.0f ns each\n", lookup[0] / lookups * 1e9);
+    printf("Lookups, second pass:   %8.0f ns each (%ld hits in both passes, values %s)\n",
+           lookup[1] / lookups * 1e9, hits, correct == hits ? "correct" : "WRONG");
+    return 0;
+}
+
+// Function to run one writer and one reader process on the same file at the same time
+int stress(const char *path, long n) {
+    unlink(path);
+    MappedTable t;
+    if (tableOpen(&t, path, 1) != 0) {
+        perror(path);
+        return 1;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        // Reader: "progress" tells how many keys exist; each of them must be found with its value
+        MappedTable r;
+        if (tableOpen(&r, path, 0) != 0) _exit(2);
+        uint64_t state = 88172645463325252ULL, progress = 0;
+        long checks = 0, errors = 0;
+        char key[32];
+        while (progress < (uint64_t)n) {
+            if (tableGet(&r, "progress", 8, &progress) != 1) continue;
+            for (int i = 0; i < 100 && progress > 0; i++) {
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                uint64_t k = state % progress, v;
+                int len = sprintf(key, "key-%llu", (unsigned long long)k);
+                if (tableGet(&r, key, len, &v) != 1 || v != k * 7) errors++;
+                checks++;
+            }
+        }
+        printf("Reader: %ld lookups during the writes, %ld errors\n", checks, errors);
+        fflush(stdout);
+        tableClose(&r);
+        _exit(errors == 0 ? 0 : 1);
+    }
+    char key[32];
+    for (long i = 0; i < n; i++) {
+        int len = sprintf(key, "key-%ld", i);
+        if (tableAdd(&t, key, len, (uint64_t)i * 7) != 0) {
+            perror("tableAdd");
+            return 1;
+        }
+        tableAdd(&t, "progress", 8, 1);   // Published after key i
+    }
+    int status;
+    waitpid(child, &status, 0);
+    printf("Writer: %ld keys, table grew to generation %llu\n", n,
+           (unsigned long long)atomic_load(&tableHeader(&t)->generation));
+    tableClose(&t);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s FILE count TEXTFILE | get KEY... | top | bench N | stress N\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1], *command = argv[2];
+    if (strcmp(command, "bench") == 0 && argc == 4) return benchmark(path, atol(argv[3]));
+    if (strcmp(command, "stress") == 0 && argc == 4) return stress(path, atol(argv[3]));
+
+    MappedTable t;
+    int writable = strcmp(command, "count") == 0;
+    if (tableOpen(&t, path, writable) != 0) {
+        perror(path);
+        return 1;
+    }
+    int status = 0;
+    if (writable && argc == 4) {
+        status = countWords(&t, argv[3]);
+    } else if (strcmp(command, "get") == 0) {
+        for (int i = 3; i < argc; i++) {
+            uint64_t value;
+            int found = tableGet(&t, argv[i], strlen(argv[i]), &value);
+            if (found < 0) {
+                fprintf(stderr, "%s: a writer stopped while growing the table; open it with 'count' to repair it\n", path);
+                status = 1;
+                break;
+            } else if (found == 1) {
+                printf("%-20s %llu\n", argv[i], (unsigned long long)value);
+            } else {
+                printf("%-20s (not found)\n", argv[i]);
+                status = 1;
+            }
+        }
+    } else if (strcmp(command, "top") == 0) {
+        printStats(&t);
+    } else {
+        fprintf(stderr, "Unknown command: %s\n", command);
+        status = 2;
+    }
+    tableClose(&t);
+    return status;
+}
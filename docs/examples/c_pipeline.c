@@ -0,0 +1,324 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+/*
+    A READ / PROCESS PIPELINE OVER LOCK-FREE RINGS
+
+    The Problem:
+    - A loop that reads a block and then processes it leaves the CPU idle
+      while it waits for the disk, and the disk idle while it computes.
+      The total time is read time + compute time.
+
+    The Pipeline:
+    - A reader thread fills buffers and hands them to the first stage.
+      Each stage processes a buffer and hands it to the next one. The last
+      stage gives the buffer back to the reader, which fills it again.
+    - Every stage runs on its own thread, so while stage 2 works on buffer
+      3, stage 1 works on buffer 4 and the reader fills buffer 5. The total
+      time becomes roughly that of the slowest stage.
+
+        reader -> [ring] -> count -> [ring] -> hash -> [ring] -> reader
+                                                        (free buffers)
+
+    Single-Producer/Single-Consumer Rings:
+    - Each ring has exactly one thread that pushes and one that pops, so
+      it needs no lock and no compare-and-swap: the producer owns 'tail',
+      the consumer owns 'head', and each only reads the other's index.
+    - There are never more buffers than ring slots, so a push never finds
+      the ring full. Only an empty ring makes a thread wait: it spins
+      briefly, then sleeps on a futex until the producer wakes it.
+
+    Usage:
+        pipeline [-b KB] [-n buffers] [-r MB/s] FILE
+        -r  limit the reader to this rate, to simulate a slow disk
+*/
+
+#define MAX_BUFFERS 64
+#define RING_SIZE MAX_BUFFERS       // Power of two, at least the number of buffers
+#define STAGES 2
+
+typedef struct {
+    char *data;
+    size_t length;                  // 0 marks the end of the input
+} Buffer;
+
+typedef struct {
+    _Alignas(64) _Atomic uint32_t head;         // Next slot to pop (consumer)
+    _Atomic uint32_t consumerWaiting;
+    _Alignas(64) _Atomic uint32_t tail;         // Next slot to fill (producer)
+    _Alignas(64) Buffer *slots[RING_SIZE];
+    uint64_t waits;                             // Times the consumer had to sleep
+} Ring;
+
+/* ---------- SPSC ring ---------- */
+
+static long futexWait(_Atomic uint32_t *address, uint32_t expected) {
+    return syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static long futexWake(_Atomic uint32_t *address) {
+    return syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// Function to add a buffer (producer only); never blocks, because the ring can hold every buffer
+void ringPush(Ring *r, Buffer *b) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    r->slots[tail & (RING_SIZE - 1)] = b;
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    // The store above and the load below must not be reordered, or a sleeping consumer could be missed
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&r->consumerWaiting, memory_order_relaxed)) futexWake(&r->tail);
+}
+
+// Function to take the next buffer (consumer only), waiting while the ring is empty
+Buffer *ringPop(Ring *r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    for (int spin = 0; atomic_load_explicit(&r->tail, memory_order_acquire) == head; spin++) {
+        if (spin < 100) {
+            __builtin_ia32_pause();
+            continue;
+        }
+        // Announce that we sleep, then look again before sleeping
+        atomic_store_explicit(&r->consumerWaiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&r->tail, memory_order_acquire) == head) {
+            r->waits++;
+            futexWait(&r->tail, head);     // Returns at once if tail is no longer 'head'
+        }
+        atomic_store_explicit(&r->consumerWaiting, 0, memory_order_relaxed);
+    }
+    Buffer *b = r->slots[head & (RING_SIZE - 1)];
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return b;
+}
+
+/* ---------- The work ---------- */
+
+typedef struct {
+    uint64_t chars, lines, words;
+    int inWord;
+} Counts;
+
+static const unsigned char separators[256] = {[' '] = 1, ['\n'] = 1, ['\t'] = 1};
+
+// Function to count a buffer; inWord carries over, so words split between buffers count once
+void countBuffer(Counts *c, const unsigned char *p, size_t n) {
+    uint64_t lines = 0, words = 0;
+    int inWord = c->inWord;
+    for (size_t i = 0; i < n; i++) {
+        int separator = separators[p[i]];
+        lines += p[i] == '\n';
+        words += !separator & !inWord;
+        inWord = !separator;
+    }
+    c->chars += n;
+    c->lines += lines;
+    c->words += words;
+    c->inWord = inWord;
+}
+
+// Function to update a running 64-bit hash of the data (the second stage's work)
+uint64_t hashBuffer(uint64_t h, const unsigned char *p, size_t n) {
+    for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ---------- Reading ---------- */
+
+typedef struct {
+    int fd;
+    size_t bufferSize;
+    double rate;                    // Bytes per second, 0 = unlimited
+    uint64_t total;
+} Reader;
+
+// Function to fill a buffer; with a rate limit, also sleeps as long as a slow disk would take
+ssize_t readBuffer(Reader *r, Buffer *b) {
+    size_t got = 0;
+    while (got < r->bufferSize) {
+        ssize_t n = read(r->fd, b->data + got, r->bufferSize - got);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        got += n;
+    }
+    b->length = got;
+    r->total += got;
+    if (r->rate > 0 && got > 0) {
+        double wait = got / r->rate;
+        struct timespec ts = {(time_t)wait, (long)((wait - (time_t)wait) * 1e9)};
+        nanosleep(&ts, NULL);
+    }
+    return got;
+}
+
+/* ---------- Pipelined run ---------- */
+
+typedef struct {
+    Ring rings[STAGES + 1];         // rings[i] feeds stage i; rings[STAGES] returns free buffers
+    Counts counts;
+    uint64_t hash;
+    double busy[STAGES];            // Seconds each stage spent working
+} Pipeline;
+
+void *countStage(void *arg) {
+    Pipeline *p = arg;
+    for (;;) {
+        Buffer *b = ringPop(&p->rings[0]);
+        double start = nowSeconds();
+        countBuffer(&p->counts, (unsigned char *)b->data, b->length);
+        p->busy[0] += nowSeconds() - start;
+        int last = b->length == 0;         // Read before the push: then the buffer belongs to the next stage
+        ringPush(&p->rings[1], b);
+        if (last) return NULL;
+    }
+}
+
+void *hashStage(void *arg) {
+    Pipeline *p = arg;
+    for (;;) {
+        Buffer *b = ringPop(&p->rings[1]);
+        if (b->length == 0) return NULL;   // The reader is finished; nothing comes back
+        double start = nowSeconds();
+        p->hash = hashBuffer(p->hash, (unsigned char *)b->data, b->length);
+        p->busy[1] += nowSeconds() - start;
+        ringPush(&p->rings[2], b);
+    }
+}
+
+// Function to run the reader on this thread and the stages on their own threads
+int runPipelined(Reader *reader, Buffer *buffers, int count, Pipeline *p) {
+    memset(p, 0, sizeof(*p));
+    p->hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < count; i++) ringPush(&p->rings[STAGES], &buffers[i]);
+    pthread_t threads[STAGES];
+    pthread_create(&threads[0], NULL, countStage, p);
+    pthread_create(&threads[1], NULL, hashStage, p);
+    int status = 0;
+    for (;;) {
+        Buffer *b = ringPop(&p->rings[STAGES]);
+        ssize_t n = readBuffer(reader, b);
+        if (n < 0) {
+            perror("read");
+            status = -1;
+            b->length = 0;
+        }
+        int last = b->length == 0;
+        ringPush(&p->rings[0], b);
+        if (last) break;                   // The end marker travels through every stage
+    }
+    for (int i = 0; i < STAGES; i++) pthread_join(threads[i], NULL);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    size_t bufferSize = 1 << 20;
+    int count = 8, opt;
+    double rate = 0;
+    while ((opt = getopt(argc, argv, "b:n:r:")) != -1) {
+        if (opt == 'b') bufferSize = (size_t)atol(optarg) * 1024;
+        else if (opt == 'n') count = atoi(optarg);
+        else if (opt == 'r') rate = atof(optarg) * 1e6;
+        else {
+            fprintf(stderr, "Usage: %s [-b KB] [-n buffers] [-r MB/s] FILE\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1 || bufferSize == 0 || count < 2 || count > MAX_BUFFERS) {
+        fprintf(stderr, "Usage: %s [-b KB] [-n buffers 2-%d] [-r MB/s] FILE\n", argv[0], MAX_BUFFERS);
+        return 2;
+    }
+    const char *path = argv[optind];
+
+    // The buffer pool: allocated once, recycled through the rings
+    Buffer buffers[MAX_BUFFERS];
+    for (int i = 0; i < count; i++) {
+        buffers[i].data = malloc(bufferSize);
+        if (buffers[i].data == NULL) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+    }
+
+    // 1. Sequential: read, count, hash, one after the other
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    Reader reader = {fd, bufferSize, rate, 0};
+    double start = nowSeconds();
+    Counts seqCounts = {0, 0, 0, 0};
+    uint64_t seqHash = 0xcbf29ce484222325ULL;
+    double readTime = 0, countTime = 0, hashTime = 0, t;
+    for (;;) {
+        t = nowSeconds();
+        ssize_t n = readBuffer(&reader, &buffers[0]);
+        readTime += nowSeconds() - t;
+        if (n < 0) {
+            perror(path);
+            return 1;
+        }
+        if (n == 0) break;
+        t = nowSeconds();
+        countBuffer(&seqCounts, (unsigned char *)buffers[0].data, n);
+        countTime += nowSeconds() - t;
+        t = nowSeconds();
+        seqHash = hashBuffer(seqHash, (unsigned char *)buffers[0].data, n);
+        hashTime += nowSeconds() - t;
+    }
+    double sequential = nowSeconds() - start;
+    close(fd);
+
+    // 2. Pipelined
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    reader = (Reader){fd, bufferSize, rate, 0};
+    start = nowSeconds();
+    Pipeline *p = aligned_alloc(64, (sizeof(Pipeline) + 63) / 64 * 64);
+    if (p == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    if (runPipelined(&reader, buffers, count, p) != 0) return 1;
+    double pipelined = nowSeconds() - start;
+    close(fd);
+
+    printf("%llu bytes, %d buffers of %zu KB%s\n", (unsigned long long)reader.total, count, bufferSize / 1024,
+           rate > 0 ? ", reader limited to simulate a slow disk" : "");
+    printf("lines %llu, words %llu, chars %llu, hash %016llx\n", (unsigned long long)p->counts.lines,
+           (unsigned long long)p->counts.words, (unsigned long long)p->counts.chars, (unsigned long long)p->hash);
+    printf("Sequential: %.3f s  (read %.3f + count %.3f + hash %.3f)\n", sequential, readTime, countTime, hashTime);
+    printf("Pipelined:  %.3f s  (count busy %.3f, hash busy %.3f; waits: count %llu, hash %llu, reader %llu)\n",
+           pipelined, p->busy[0], p->busy[1], (unsigned long long)p->rings[0].waits,
+           (unsigned long long)p->rings[1].waits, (unsigned long long)p->rings[2].waits);
+    int same = p->counts.lines == seqCounts.lines && p->counts.words == seqCounts.words &&
+               p->counts.chars == seqCounts.chars && p->hash == seqHash;
+    printf("Results match: %s, speedup x%.2f\n", same ? "yes" : "NO", sequential / pipelined);
+
+    free(p);
+    for (int i = 0; i < count; i++) free(buffers[i].data);
+    return same ? 0 : 1;
+}
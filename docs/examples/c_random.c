@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+    FAST RANDOM NUMBERS IN C
+
+    Problems with rand():
+    - glibc's rand() takes a lock on every call, so threads calling it at
+      the same time wait for each other.
+    - rand() % 100 is biased: unless RAND_MAX + 1 is a multiple of 100,
+      some remainders come up slightly more often than others.
+    - There is only one global sequence, so threads cannot have their own.
+
+    Generators in this file:
+    - xoshiro256++: 256 bits of state, 64-bit outputs, very fast.
+      xoshiroJump() advances a generator by 2^128 steps, so thread k can
+      use the seed generator jumped k times and the streams never overlap.
+    - PCG32: 64 bits of state, 32-bit outputs. Every odd increment gives a
+      different, independent stream.
+    - splitmix64 turns one 64-bit seed into a well-mixed full state.
+
+    Unbiased ranges (Lemire's method):
+    - Multiply a 32-bit random number by the range size; the high 32 bits
+      are the result. A rare rejection step removes the bias, and in the
+      common case no division is needed at all.
+
+    Bulk fill:
+    - xoshiroFill() runs four independent xoshiro states side by side.
+      With AVX2 the four states sit in one 256-bit register and are
+      stepped by one instruction each; without AVX2 the same four lanes
+      are stepped in plain C and produce the same numbers.
+*/
+
+typedef struct {
+    uint64_t s[4];
+} Xoshiro256;
+
+typedef struct {
+    uint64_t state;
+    uint64_t inc;
+} Pcg32;
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Function to mix a seed into a new 64-bit value (used for seeding)
+uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void xoshiroSeed(Xoshiro256 *g, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        g->s[i] = splitmix64(&seed);
+    }
+}
+
+uint64_t xoshiroNext(Xoshiro256 *g) {
+    uint64_t *s = g->s;
+    uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Function to advance the generator by 2^128 steps (one independent stream)
+void xoshiroJump(Xoshiro256 *g) {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= g->s[0];
+                s1 ^= g->s[1];
+                s2 ^= g->s[2];
+                s3 ^= g->s[3];
+            }
+            xoshiroNext(g);
+        }
+    }
+    g->s[0] = s0;
+    g->s[1] = s1;
+    g->s[2] = s2;
+    g->s[3] = s3;
+}
+
+// Function to seed a PCG32 generator; 'stream' selects an independent sequence
+void pcgSeed(Pcg32 *g, uint64_t seed, uint64_t stream) {
+    g->state = 0;
+    g->inc = (stream << 1) | 1;
+    g->state = g->state * 6364136223846793005ULL + g->inc;
+    g->state += seed;
+    g->state = g->state * 6364136223846793005ULL + g->inc;
+}
+
+uint32_t pcgNext(Pcg32 *g) {
+    uint64_t old = g->state;
+    g->state = old * 6364136223846793005ULL + g->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// Function to get an unbiased number in [0, range) with Lemire's method
+uint32_t boundedLemire(uint32_t (*next)(void *), void *g, uint32_t range) {
+    uint64_t m = (uint64_t)next(g) * range;
+    uint32_t low = (uint32_t)m;
+    if (low < range) {
+        uint32_t threshold = -range % range;   // (2^32 - range) % range
+        while (low < threshold) {
+            m = (uint64_t)next(g) * range;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+uint32_t xoshiroNext32(void *g) {
+    return (uint32_t)(xoshiroNext((Xoshiro256 *)g) >> 32);
+}
+
+uint32_t pcgNext32(void *g) {
+    return pcgNext((Pcg32 *)g);
+}
+
+uint32_t xoshiroBounded(Xoshiro256 *g, uint32_t range) {
+    return boundedLemire(xoshiroNext32, g, range);
+}
+
+uint32_t pcgBounded(Pcg32 *g, uint32_t range) {
+    return boundedLemire(pcgNext32, g, range);
+}
+
+/*
+    Four-lane generator for bulk fills.
+    Lane k starts from the seed generator jumped k times.
+    Output order: lane 0, 1, 2, 3, lane 0, 1, 2, 3, ...
+*/
+typedef struct {
+    uint64_t s[4][4];   // s[word][lane]
+} Xoshiro256x4;
+
+void xoshiroX4Seed(Xoshiro256x4 *g, Xoshiro256 *base) {
+    Xoshiro256 lane = *base;
+    for (int k = 0; k < 4; k++) {
+        for (int w = 0; w < 4; w++) g->s[w][k] = lane.s[w];
+        xoshiroJump(&lane);
+    }
+}
+
+// Function to fill an array with random 64-bit numbers, four at a time
+void xoshiroFill(Xoshiro256x4 *g, uint64_t *out, size_t n) {
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256i s0 = _mm256_loadu_si256((__m256i *)g->s[0]);
+    __m256i s1 = _mm256_loadu_si256((__m256i *)g->s[1]);
+    __m256i s2 = _mm256_loadu_si256((__m256i *)g->s[2]);
+    __m256i s3 = _mm256_loadu_si256((__m256i *)g->s[3]);
+    for (; i + 4 <= n; i += 4) {
+        __m256i sum = _mm256_add_epi64(s0, s3);
+        __m256i rotated = _mm256_or_si256(_mm256_slli_epi64(sum, 23), _mm256_srli_epi64(sum, 41));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi64(rotated, s0));
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+    }
+    _mm256_storeu_si256((__m256i *)g->s[0], s0);
+    _mm256_storeu_si256((__m256i *)g->s[1], s1);
+    _mm256_storeu_si256((__m256i *)g->s[2], s2);
+    _mm256_storeu_si256((__m256i *)g->s[3], s3);
+#endif
+    // Portable version of the same four lanes (also handles the tail)
+    while (i < n) {
+        uint64_t block[4];
+        for (int k = 0; k < 4; k++) {
+            uint64_t s0 = g->s[0][k], s1 = g->s[1][k], s2 = g->s[2][k], s3 = g->s[3][k];
+            block[k] = rotl(s0 + s3, 23) + s0;
+            uint64_t t = s1 << 17;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = rotl(s3, 45);
+            g->s[0][k] = s0;
+            g->s[1][k] = s1;
+            g->s[2][k] = s2;
+            g->s[3][k] = s3;
+        }
+        for (int k = 0; k < 4 && i < n; k++) out[i++] = block[k];
+    }
+}
+
+// Function to read a monotonic clock in seconds
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define MAX_THREADS 64
+#define CALLS_PER_THREAD 5000000
+
+// One cache line per job, so threads never write to a line another thread uses
+typedef struct {
+    _Alignas(64) Xoshiro256 rng;
+    uint64_t sink;   // Keeps the compiler from removing the loop
+} ThreadJob;
+
+void *randWorker(void *arg) {
+    ThreadJob *job = (ThreadJob *)arg;
+    uint64_t sum = 0;
+    for (int i = 0; i < CALLS_PER_THREAD; i++) sum += rand() % 100 + 1;
+    job->sink = sum;
+    return NULL;
+}
+
+void *xoshiroWorker(void *arg) {
+    ThreadJob *job = (ThreadJob *)arg;
+    Xoshiro256 rng = job->rng;      // A local copy stays in registers
+    uint64_t sum = 0;
+    for (int i = 0; i < CALLS_PER_THREAD; i++) sum += xoshiroBounded(&rng, 100) + 1;
+    job->rng = rng;
+    job->sink = sum;
+    return NULL;
+}
+
+// Function to time 'threads' threads all drawing numbers in 1..100
+double timeThreads(int threads, void *(*worker)(void *), Xoshiro256 *seed) {
+    pthread_t ids[MAX_THREADS];
+    ThreadJob jobs[MAX_THREADS];
+    Xoshiro256 stream = *seed;
+    for (int i = 0; i < threads; i++) {
+        jobs[i].rng = stream;   // Each thread gets its own jumped stream
+        jobs[i].sink = 0;
+        xoshiroJump(&stream);
+    }
+    double start = nowSeconds();
+    for (int i = 0; i < threads; i++) pthread_create(&ids[i], NULL, worker, &jobs[i]);
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    return nowSeconds() - start;
+}
+
+int main(int argc, char *argv[]) {
+    Xoshiro256 rng;
+    Pcg32 pcg;
+    xoshiroSeed(&rng, (uint64_t)time(NULL));
+    pcgSeed(&pcg, (uint64_t)time(NULL), 54);
+
+    // Drop-in replacement for: secret = rand() % 100 + 1;
+    printf("xoshiro256++ secret (1-100): %u\n", xoshiroBounded(&rng, 100) + 1);
+    printf("PCG32 secret (1-100):        %u\n", pcgBounded(&pcg, 100) + 1);
+
+    // Fixed seeds give repeatable sequences, which is useful for tests
+    Xoshiro256 fixed;
+    xoshiroSeed(&fixed, 42);
+    printf("Seed 42, first three numbers:");
+    for (int i = 0; i < 3; i++) printf(" %u", xoshiroBounded(&fixed, 1000));
+    printf("\n");
+
+    // Bulk fill: the AVX2 and portable paths produce the same numbers
+    size_t count = 50000000;
+    uint64_t *buffer = (uint64_t *)malloc(count * sizeof(uint64_t));
+    if (buffer == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    Xoshiro256x4 wide;
+    xoshiroX4Seed(&wide, &rng);
+    double start = nowSeconds();
+    xoshiroFill(&wide, buffer, count);
+    double fillTime = nowSeconds() - start;
+    printf("Filled %zu numbers in %.3f s (%.0f million/s)\n", count, fillTime, count / fillTime / 1e6);
+    free(buffer);
+
+    // Contention benchmark: rand() against per-thread xoshiro streams
+    int maxThreads = argc > 1 ? atoi(argv[1]) : 4;
+    if (maxThreads > MAX_THREADS) maxThreads = MAX_THREADS;
+    printf("Threads | rand() M/s | xoshiro M/s\n");
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double total = (double)threads * CALLS_PER_THREAD / 1e6;
+        double randTime = timeThreads(threads, randWorker, &rng);
+        double xoshiroTime = timeThreads(threads, xoshiroWorker, &rng);
+        printf("%7d | %10.1f | %11.1f\n", threads, total / randTime, total / xoshiroTime);
+    }
+
+    return 0;
+}
@@ -0,0 +1,455 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+
+/*
+    ROPES IN C
+
+    The problem with flat strings:
+    - Inserting or deleting text in the middle of a char[] means moving
+      every byte after the edit with memmove(), which is O(n).
+    - For a multi-megabyte buffer edited thousands of times, that is a lot
+      of copying.
+
+    What is a rope?
+    - A balanced binary tree whose nodes each hold a small chunk of text.
+    - Reading the chunks in order (left subtree, node, right subtree) gives
+      the whole string.
+    - Every node also stores the total number of bytes in its subtree, so we
+      can walk down to any byte position in O(log n).
+
+    Balancing:
+    - This rope is a "treap": every node gets a random priority, and a
+      parent always has a priority at least as high as its children.
+      Random priorities keep the tree depth O(log n) on average without
+      any rotations to write.
+    - split() cuts a tree into the first k bytes and the rest.
+    - merge() joins two trees whose contents follow each other.
+    - insert = split + merge, delete = split twice + merge.
+    - Where two trees are merged after an edit, the chunks on both sides
+      of the seam are joined into one if they fit. Without this, every
+      split leaves a short chunk behind, and many edits turn the rope
+      into a tree of tiny nodes.
+
+    Zero-copy output:
+    - The RopeIter walks the chunks in order, and ropeWrite() hands many
+      chunks at once to writev(), so the text is never copied into a
+      single big buffer just to be written out.
+*/
+
+#define CHUNK_SIZE 1024
+#define IOV_BATCH 64
+
+typedef struct RopeNode {
+    struct RopeNode *left, *right;
+    unsigned priority;
+    size_t size;               // Bytes in this whole subtree
+    size_t length;             // Bytes in this node's chunk
+    char data[CHUNK_SIZE];
+} RopeNode;
+
+typedef struct {
+    RopeNode *root;
+} Rope;
+
+static unsigned randomState = 2463534242u;
+
+// Function to produce a random priority (xorshift)
+unsigned nextPriority(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+size_t nodeSize(RopeNode *t) {
+    return t != NULL ? t->size : 0;
+}
+
+// Function to recompute a node's subtree size from its children
+void updateSize(RopeNode *t) {
+    t->size = nodeSize(t->left) + t->length + nodeSize(t->right);
+}
+
+// Function to create a node holding up to CHUNK_SIZE bytes
+RopeNode *newNode(const char *text, size_t n, unsigned priority) {
+    RopeNode *t = (RopeNode *)malloc(sizeof(RopeNode));
+    if (t == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    t->left = t->right = NULL;
+    t->priority = priority;
+    t->length = n;
+    memcpy(t->data, text, n);
+    updateSize(t);
+    return t;
+}
+
+// Function to join two trees: all of 'a' comes before all of 'b'
+RopeNode *merge(RopeNode *a, RopeNode *b) {
+    if (a == NULL) return b;
+    if (b == NULL) return a;
+    if (a->priority >= b->priority) {
+        a->right = merge(a->right, b);
+        updateSize(a);
+        return a;
+    } else {
+        b->left = merge(a, b->left);
+        updateSize(b);
+        return b;
+    }
+}
+
+// Function to split a tree into the first k bytes (*l) and the rest (*r)
+void split(RopeNode *t, size_t k, RopeNode **l, RopeNode **r) {
+    if (t == NULL) {
+        *l = *r = NULL;
+        return;
+    }
+    size_t leftSize = nodeSize(t->left);
+    if (k <= leftSize) {
+        split(t->left, k, l, &t->left);
+        updateSize(t);
+        *r = t;
+    } else if (k >= leftSize + t->length) {
+        split(t->right, k - leftSize - t->length, &t->right, r);
+        updateSize(t);
+        *l = t;
+    } else {
+        // The cut falls inside this chunk: move the tail to a new node.
+        // Giving it the same priority keeps the heap order valid.
+        size_t offset = k - leftSize;
+        RopeNode *tail = newNode(t->data + offset, t->length - offset, t->priority);
+        tail->right = t->right;
+        updateSize(tail);
+        t->right = NULL;
+        t->length = offset;
+        updateSize(t);
+        *l = t;
+        *r = tail;
+    }
+}
+
+// Function to remove the first chunk's node from a tree and return it
+RopeNode *takeFirst(RopeNode **t) {
+    RopeNode *first;
+    if ((*t)->left != NULL) {
+        first = takeFirst(&(*t)->left);
+        updateSize(*t);
+    } else {
+        // Its right child has a lower priority, so it can take the node's place
+        first = *t;
+        *t = first->right;
+    }
+    return first;
+}
+
+// Function to append bytes to the last chunk of a tree (the caller checks that they fit)
+void appendToLast(RopeNode *t, const char *text, size_t n) {
+    if (t->right != NULL) {
+        appendToLast(t->right, text, n);
+    } else {
+        memcpy(t->data + t->length, text, n);
+        t->length += n;
+    }
+    t->size += n;
+}
+
+// Function to merge two trees, first joining the chunks at the seam if they fit into one
+RopeNode *mergeJoined(RopeNode *a, RopeNode *b) {
+    if (a != NULL && b != NULL) {
+        RopeNode *last = a, *first = b;
+        while (last->right != NULL) last = last->right;
+        while (first->left != NULL) first = first->left;
+        if (last->length + first->length <= CHUNK_SIZE) {
+            appendToLast(a, first->data, first->length);
+            free(takeFirst(&b));
+        }
+    }
+    return merge(a, b);
+}
+
+// Function to build a tree from text, CHUNK_SIZE bytes per node
+RopeNode *buildTree(const char *text, size_t n) {
+    RopeNode *t = NULL;
+    for (size_t done = 0; done < n; done += CHUNK_SIZE) {
+        size_t take = n - done < CHUNK_SIZE ? n - done : CHUNK_SIZE;
+        t = merge(t, newNode(text + done, take, nextPriority()));
+    }
+    return t;
+}
+
+void freeTree(RopeNode *t) {
+    if (t == NULL) return;
+    freeTree(t->left);
+    freeTree(t->right);
+    free(t);
+}
+
+// Function to insert in place when the target chunk still has room.
+// Returns 1 on success, 0 if the caller must split and merge instead.
+int insertInChunk(RopeNode *t, size_t pos, const char *text, size_t n) {
+    if (t == NULL) return 0;
+    size_t leftSize = nodeSize(t->left);
+    int done;
+    if (pos < leftSize) {
+        done = insertInChunk(t->left, pos, text, n);
+    } else if (pos <= leftSize + t->length) {
+        size_t offset = pos - leftSize;
+        done = t->length + n <= CHUNK_SIZE;
+        if (done) {
+            memmove(t->data + offset + n, t->data + offset, t->length - offset);
+            memcpy(t->data + offset, text, n);
+            t->length += n;
+        }
+    } else {
+        done = insertInChunk(t->right, pos - leftSize - t->length, text, n);
+    }
+    if (done) t->size += n;
+    return done;
+}
+
+void ropeInit(Rope *rope, const char *text, size_t n) {
+    rope->root = buildTree(text, n);
+}
+
+size_t ropeLength(Rope *rope) {
+    return nodeSize(rope->root);
+}
+
+// Function to insert n bytes of text before byte position pos
+void ropeInsert(Rope *rope, size_t pos, const char *text, size_t n) {
+    if (n == 0 || insertInChunk(rope->root, pos, text, n)) {
+        return;
+    }
+    RopeNode *l, *r;
+    split(rope->root, pos, &l, &r);
+    rope->root = mergeJoined(mergeJoined(l, buildTree(text, n)), r);
+}
+
+// Function to delete n bytes starting at byte position pos
+void ropeDelete(Rope *rope, size_t pos, size_t n) {
+    RopeNode *l, *middle, *r;
+    split(rope->root, pos, &l, &r);
+    split(r, n, &middle, &r);
+    freeTree(middle);
+    rope->root = mergeJoined(l, r);
+}
+
+// Function to read the byte at position pos (pos < ropeLength)
+char ropeIndex(Rope *rope, size_t pos) {
+    RopeNode *t = rope->root;
+    while (t != NULL) {
+        size_t leftSize = nodeSize(t->left);
+        if (pos < leftSize) {
+            t = t->left;
+        } else if (pos < leftSize + t->length) {
+            return t->data[pos - leftSize];
+        } else {
+            pos -= leftSize + t->length;
+            t = t->right;
+        }
+    }
+    return '\0';
+}
+
+void ropeFree(Rope *rope) {
+    freeTree(rope->root);
+    rope->root = NULL;
+}
+
+/*
+    Chunk Iterator:
+    - An in-order walk with an explicit stack of the nodes whose chunk
+      has not been visited yet.
+*/
+typedef struct {
+    RopeNode **stack;
+    size_t depth, capacity;
+} RopeIter;
+
+void pushLeftSpine(RopeIter *it, RopeNode *t) {
+    for (; t != NULL; t = t->left) {
+        if (it->depth == it->capacity) {
+            it->capacity = it->capacity ? it->capacity * 2 : 64;
+            it->stack = (RopeNode **)realloc(it->stack, it->capacity * sizeof(RopeNode *));
+            if (it->stack == NULL) {
+                perror("realloc");
+                exit(1);
+            }
+        }
+        it->stack[it->depth++] = t;
+    }
+}
+
+void ropeIterBegin(RopeIter *it, Rope *rope) {
+    it->stack = NULL;
+    it->depth = it->capacity = 0;
+    pushLeftSpine(it, rope->root);
+}
+
+// Function to get the next chunk; returns 0 when there are no more
+int ropeIterNext(RopeIter *it, const char **data, size_t *length) {
+    while (it->depth > 0) {
+        RopeNode *t = it->stack[--it->depth];
+        pushLeftSpine(it, t->right);
+        if (t->length > 0) {
+            *data = t->data;
+            *length = t->length;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void ropeIterEnd(RopeIter *it) {
+    free(it->stack);
+}
+
+// Function to write the whole rope to fd with writev, IOV_BATCH chunks at a time
+int ropeWrite(Rope *rope, int fd) {
+    RopeIter it;
+    struct iovec iov[IOV_BATCH];
+    const char *data;
+    size_t length;
+    int more = 1;
+
+    ropeIterBegin(&it, rope);
+    while (more) {
+        int count = 0;
+        while (count < IOV_BATCH && (more = ropeIterNext(&it, &data, &length))) {
+            iov[count].iov_base = (void *)data;
+            iov[count].iov_len = length;
+            count++;
+        }
+        // writev may write less than asked: skip what was written and retry
+        struct iovec *pending = iov;
+        while (count > 0) {
+            ssize_t written = writev(fd, pending, count);
+            if (written < 0) {
+                ropeIterEnd(&it);
+                return -1;
+            }
+            while (count > 0 && (size_t)written >= pending->iov_len) {
+                written -= pending->iov_len;
+                pending++;
+                count--;
+            }
+            if (count > 0) {
+                pending->iov_base = (char *)pending->iov_base + written;
+                pending->iov_len -= written;
+            }
+        }
+    }
+    ropeIterEnd(&it);
+    return 0;
+}
+
+// Function to read a monotonic clock in seconds
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to compare edit throughput of a rope and a flat buffer
+void benchmarkEdits(size_t initialSize, int edits) {
+    char *flat = (char *)malloc(initialSize + (size_t)edits * 16 + 1);
+    if (flat == NULL) {
+        printf("Out of memory.\n");
+        return;
+    }
+    for (size_t i = 0; i < initialSize; i++) {
+        flat[i] = 'a' + i % 26;
+    }
+    size_t flatLength = initialSize;
+
+    Rope rope;
+    ropeInit(&rope, flat, flatLength);
+
+    const char *snippet = "<inserted text!>";
+    size_t snippetLength = strlen(snippet);
+
+    // The same pseudo-random edit positions are used for both structures
+    unsigned seed = 12345;
+    double start = nowSeconds();
+    for (int i = 0; i < edits; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t pos = seed % (flatLength - snippetLength);
+        if (i % 2 == 0) {
+            memmove(flat + pos + snippetLength, flat + pos, flatLength - pos);
+            memcpy(flat + pos, snippet, snippetLength);
+            flatLength += snippetLength;
+        } else {
+            memmove(flat + pos, flat + pos + snippetLength / 2, flatLength - pos - snippetLength / 2);
+            flatLength -= snippetLength / 2;
+        }
+    }
+    double flatTime = nowSeconds() - start;
+
+    seed = 12345;
+    start = nowSeconds();
+    for (int i = 0; i < edits; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t pos = seed % (ropeLength(&rope) - snippetLength);
+        if (i % 2 == 0) {
+            ropeInsert(&rope, pos, snippet, snippetLength);
+        } else {
+            ropeDelete(&rope, pos, snippetLength / 2);
+        }
+    }
+    double ropeTime = nowSeconds() - start;
+
+    // Check that both structures hold the same text
+    int same = ropeLength(&rope) == flatLength;
+    RopeIter it;
+    const char *data;
+    size_t length, offset = 0, chunks = 0;
+    ropeIterBegin(&it, &rope);
+    while (same && ropeIterNext(&it, &data, &length)) {
+        same = memcmp(flat + offset, data, length) == 0;
+        offset += length;
+        chunks++;
+    }
+    ropeIterEnd(&it);
+
+    printf("%d edits on a %zu-byte buffer:\n", edits, initialSize);
+    printf("  Flat buffer (memmove): %.4f s (%.0f edits/s)\n", flatTime, edits / flatTime);
+    printf("  Rope:                  %.4f s (%.0f edits/s)\n", ropeTime, edits / ropeTime);
+    printf("  Rope chunks: %zu (%.0f bytes on average)\n", chunks, (double)offset / chunks);
+    printf("  Contents match: %s\n", same ? "yes" : "no");
+
+    ropeFree(&rope);
+    free(flat);
+}
+
+int main(int argc, char *argv[]) {
+    Rope rope;
+    const char *text = "Hello World";
+    ropeInit(&rope, text, strlen(text));
+
+    ropeInsert(&rope, 5, ",", 1);
+    ropeInsert(&rope, ropeLength(&rope), "!\n", 2);
+    printf("Rope after inserts: ");
+    fflush(stdout);
+    ropeWrite(&rope, STDOUT_FILENO);
+
+    ropeDelete(&rope, 0, 7);
+    printf("Rope after delete:  ");
+    fflush(stdout);
+    ropeWrite(&rope, STDOUT_FILENO);
+    printf("Character at index 2: %c\n", ropeIndex(&rope, 2));
+    ropeFree(&rope);
+
+    // Benchmark: buffer size (bytes) and number of edits from the command line
+    size_t size = argc > 1 ? (size_t)atol(argv[1]) : 4 * 1024 * 1024;
+    int edits = argc > 2 ? atoi(argv[2]) : 5000;
+    benchmarkEdits(size, edits);
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+#define _GNU_SOURCE      // For sched_getcpu()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+/*
+    SHARDED COUNTERS
+
+    The static counter pattern:
+    - staticCounter() in the Functions & Structure notes does count++ on
+      one static int. With threads, two increments can read the same old
+      value and one of them is lost (a data race).
+    - Making it atomic fixes the race, but every increment now needs the
+      cache line holding the counter in exclusive mode. With many threads
+      the line moves from core to core on every increment ("cache-line
+      ping-pong"), and each increment costs tens to hundreds of ns.
+
+    Sharding:
+    - Every thread (or every CPU) gets its own shard: a 64-byte-aligned
+      row holding one slot for every registered counter.
+    - counterAdd() only writes the slot in its own shard. Nobody else
+      writes that cache line, so it stays in the core's cache. Relaxed
+      order is enough: a counter only needs its total, not ordering with
+      other memory.
+    - counterRead() adds up one slot from every shard. Reads are rare
+      (metrics export), so they can afford to touch every shard.
+
+    Shard selection:
+    - SHARD_PER_THREAD: each thread claims a free shard from a 64-bit mask
+      on its first add, and a pthread key destructor gives it back when
+      the thread exits. A claimed shard has exactly one writer, so the add
+      is a plain relaxed load and store, without a locked instruction.
+      Beyond 64 live threads, the extra threads all use one overflow shard
+      that is never owned, with an atomic add. They must not share an
+      owned shard: the owner's plain store would overwrite their adds.
+    - SHARD_PER_CPU: sched_getcpu(). A thread may move to another CPU
+      between reading the CPU number and the add, which is why the add is
+      still atomic; it is just almost never contended.
+
+    False sharing:
+    - Giving each thread its own counter is not enough if those counters
+      sit next to each other in one cache line. The benchmark includes
+      that "unpadded" layout to show it.
+*/
+
+#define MAX_COUNTERS 64
+#define MAX_SHARDS 64
+#define MAX_THREADS 64
+#define CACHE_LINE 64
+
+typedef enum { SHARD_PER_THREAD, SHARD_PER_CPU } ShardMode;
+
+// One row per shard; a thread's counters share its own cache lines and nobody else's
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic uint64_t slots[MAX_COUNTERS];
+} ShardRow;
+
+typedef int Counter;     // Index of a registered counter
+
+#define OVERFLOW_SHARD MAX_SHARDS    // Never owned; shared by threads that found no free shard
+
+ShardRow shards[MAX_SHARDS + 1];
+const char *counterNames[MAX_COUNTERS];
+atomic_int counterCount;
+_Atomic uint64_t shardsInUse;    // Bit s set: shard s is owned by a live thread
+pthread_key_t shardKey;
+pthread_once_t shardKeyOnce = PTHREAD_ONCE_INIT;
+ShardMode shardMode = SHARD_PER_THREAD;
+_Thread_local int threadShard = -1;
+_Thread_local int threadOwnsShard;
+
+// Function to register a named counter; returns -1 when the table is full
+Counter counterRegister(const char *name) {
+    int id = atomic_fetch_add(&counterCount, 1);
+    if (id >= MAX_COUNTERS) return -1;
+    counterNames[id] = name;
+    return id;
+}
+
+// Called when a thread that owns a shard exits
+void releaseShard(void *value) {
+    int shard = (int)(intptr_t)value - 1;
+    atomic_fetch_and(&shardsInUse, ~(1ULL << shard));
+}
+
+void createShardKey(void) {
+    pthread_key_create(&shardKey, releaseShard);
+}
+
+// Function to give the calling thread a shard, exclusively if one is free
+void claimShard(void) {
+    pthread_once(&shardKeyOnce, createShardKey);
+    uint64_t used = atomic_load(&shardsInUse);
+    while (used != ~0ULL) {
+        int shard = __builtin_ctzll(~used);
+        if (atomic_compare_exchange_weak(&shardsInUse, &used, used | (1ULL << shard))) {
+            threadShard = shard;
+            threadOwnsShard = 1;
+            pthread_setspecific(shardKey, (void *)(intptr_t)(shard + 1));
+            return;
+        }
+    }
+    threadShard = OVERFLOW_SHARD;       // All taken
+    threadOwnsShard = 0;
+}
+
+// Function to add n to a counter (the hot path)
+static inline void counterAdd(Counter c, uint64_t n) {
+    if (shardMode == SHARD_PER_CPU) {
+        int cpu = sched_getcpu();
+        atomic_fetch_add_explicit(&shards[cpu < 0 ? 0 : cpu % MAX_SHARDS].slots[c], n, memory_order_relaxed);
+        return;
+    }
+    if (threadShard < 0) claimShard();
+    _Atomic uint64_t *slot = &shards[threadShard].slots[c];
+    if (threadOwnsShard) {
+        // Single writer: no other thread can add between this load and store
+        atomic_store_explicit(slot, atomic_load_explicit(slot, memory_order_relaxed) + n, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(slot, n, memory_order_relaxed);
+    }
+}
+
+// Function to read a counter's total (sums every shard)
+uint64_t counterRead(Counter c) {
+    uint64_t total = 0;
+    for (int s = 0; s <= MAX_SHARDS; s++) total += atomic_load_explicit(&shards[s].slots[c], memory_order_relaxed);
+    return total;
+}
+
+void counterReport(void) {
+    int count = atomic_load(&counterCount);
+    for (int c = 0; c < count && c < MAX_COUNTERS; c++) {
+        printf("  %-20s %llu\n", counterNames[c], (unsigned long long)counterRead(c));
+    }
+}
+
+/* ---------- Contention benchmark ---------- */
+
+typedef enum { PLAIN, MUTEX, ATOMIC_SHARED, UNPADDED, SHARDED_THREAD, SHARDED_CPU, METHOD_COUNT } Method;
+
+const char *methodNames[METHOD_COUNT] = {
+    "plain int (racy)", "mutex", "one atomic", "unpadded per-thread", "sharded per-thread", "sharded per-CPU",
+};
+
+volatile uint64_t plainCounter;    // volatile keeps each increment a real load and store
+uint64_t mutexCounter;
+pthread_mutex_t counterLock = PTHREAD_MUTEX_INITIALIZER;
+_Atomic uint64_t sharedCounter;
+_Atomic uint64_t unpadded[MAX_THREADS];    // 8 threads share each cache line
+Counter benchCounter;
+
+typedef struct {
+    Method method;
+    int index;
+    long iterations;
+} BenchJob;
+
+void *benchWorker(void *arg) {
+    BenchJob *job = (BenchJob *)arg;
+    long n = job->iterations;
+    switch (job->method) {
+        case PLAIN:
+            for (long i = 0; i < n; i++) plainCounter++;
+            break;
+        case MUTEX:
+            for (long i = 0; i < n; i++) {
+                pthread_mutex_lock(&counterLock);
+                mutexCounter++;
+                pthread_mutex_unlock(&counterLock);
+            }
+            break;
+        case ATOMIC_SHARED:
+            for (long i = 0; i < n; i++) atomic_fetch_add_explicit(&sharedCounter, 1, memory_order_relaxed);
+            break;
+        case UNPADDED:
+            for (long i = 0; i < n; i++) atomic_fetch_add_explicit(&unpadded[job->index], 1, memory_order_relaxed);
+            break;
+        case SHARDED_THREAD:
+        case SHARDED_CPU:
+            for (long i = 0; i < n; i++) counterAdd(benchCounter, 1);
+            break;
+        default:
+            break;
+    }
+    return NULL;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to reset every counter used by the benchmark
+void resetCounters(void) {
+    plainCounter = 0;
+    mutexCounter = 0;
+    atomic_store(&sharedCounter, 0);
+    for (int i = 0; i < MAX_THREADS; i++) atomic_store(&unpadded[i], 0);
+    for (int s = 0; s <= MAX_SHARDS; s++) atomic_store(&shards[s].slots[benchCounter], 0);
+}
+
+uint64_t methodTotal(Method method) {
+    uint64_t total = 0;
+    switch (method) {
+        case PLAIN:         return plainCounter;
+        case MUTEX:         return mutexCounter;
+        case ATOMIC_SHARED: return atomic_load(&sharedCounter);
+        case UNPADDED:
+            for (int i = 0; i < MAX_THREADS; i++) total += atomic_load(&unpadded[i]);
+            return total;
+        default:            return counterRead(benchCounter);
+    }
+}
+
+// Function to run one method on 'threads' threads; returns million increments per second
+double runBenchmark(Method method, int threads, long iterations, int *lost) {
+    pthread_t ids[MAX_THREADS];
+    BenchJob jobs[MAX_THREADS];
+    resetCounters();
+    shardMode = method == SHARDED_CPU ? SHARD_PER_CPU : SHARD_PER_THREAD;
+    double start = nowSeconds();
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (BenchJob){method, i, iterations};
+        if (pthread_create(&ids[i], NULL, benchWorker, &jobs[i]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    double elapsed = nowSeconds() - start;
+    *lost = methodTotal(method) != (uint64_t)threads * iterations;
+    return (double)threads * iterations / elapsed / 1e6;
+}
+
+// Function to check that no adds are lost when there are more live threads than shards
+int checkOverflow(long iterations) {
+    enum { THREADS = MAX_SHARDS + 16 };
+    pthread_t ids[THREADS];
+    BenchJob job = {SHARDED_THREAD, 0, iterations};
+    resetCounters();
+    shardMode = SHARD_PER_THREAD;
+    for (int i = 0; i < THREADS; i++) {
+        if (pthread_create(&ids[i], NULL, benchWorker, &job) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < THREADS; i++) pthread_join(ids[i], NULL);
+    uint64_t total = counterRead(benchCounter), expected = (uint64_t)THREADS * iterations;
+    printf("\n%d threads on %d shards: total %llu, expected %llu\n", THREADS, MAX_SHARDS,
+           (unsigned long long)total, (unsigned long long)expected);
+    return total == expected;
+}
+
+int main(int argc, char *argv[]) {
+    int maxThreads = argc > 1 ? atoi(argv[1]) : MAX_THREADS;
+    long iterations = argc > 2 ? atol(argv[2]) : 2000000;
+    if (maxThreads < 1 || maxThreads > MAX_THREADS) maxThreads = MAX_THREADS;
+
+    // The metrics facility: register once, add on the hot path, read on demand
+    Counter requests = counterRegister("requests");
+    Counter bytesSent = counterRegister("bytes_sent");
+    benchCounter = counterRegister("benchmark");
+    for (int i = 0; i < 1000; i++) {
+        counterAdd(requests, 1);
+        counterAdd(bytesSent, 512);
+    }
+    printf("Counters:\n");
+    counterReport();
+
+    printf("\nMillion increments per second, all threads together (%ld per thread; * = lost updates)\n",
+           iterations);
+    printf("%7s", "threads");
+    for (int m = 0; m < METHOD_COUNT; m++) printf(" | %19s", methodNames[m]);
+    printf("\n");
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        printf("%7d", threads);
+        for (int m = 0; m < METHOD_COUNT; m++) {
+            int lost;
+            double rate = runBenchmark((Method)m, threads, iterations, &lost);
+            printf(" | %18.1f%c", rate, lost ? '*' : ' ');
+        }
+        printf("\n");
+    }
+    return checkOverflow(iterations) ? 0 : 1;
+}
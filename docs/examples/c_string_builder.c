@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/*
+    LENGTH-PREFIXED STRINGS IN C
+
+    Why not plain char[]?
+    - strlen() has to scan for '\0' every time, so it is O(length).
+    - strcat(dest, src) calls strlen(dest) first, so building a string
+      out of n pieces with strcat costs O(n^2).
+    - A fixed char[100] buffer overflows silently when it gets too small.
+
+    The LString type:
+    - Stores its length and capacity next to the characters.
+    - Short strings (up to SSO_CAPACITY chars) live inside the struct
+      itself (small-string optimization), so they never call malloc().
+    - Longer strings move to the heap and the capacity doubles when it
+      runs out, so appending n bytes costs O(n) amortized.
+    - Compare and append use memcmp()/memcpy() on known lengths.
+    - The characters are always followed by '\0', so lstrData() can be
+      passed to printf("%s") and other C string functions.
+*/
+
+#define SSO_CAPACITY 23
+
+typedef struct {
+    size_t length;                  // Number of characters (without '\0')
+    size_t capacity;                // Characters that fit without growing
+    char *heap;                     // NULL while the string is inline
+    char small[SSO_CAPACITY + 1];   // Inline storage for short strings
+} LString;
+
+// Function to initialize an empty string
+void lstrInit(LString *s) {
+    s->length = 0;
+    s->capacity = SSO_CAPACITY;
+    s->heap = NULL;
+    s->small[0] = '\0';
+}
+
+// Function to get a pointer to the characters
+char *lstrData(LString *s) {
+    return s->heap != NULL ? s->heap : s->small;
+}
+
+// Function to make room for at least 'needed' characters
+int lstrReserve(LString *s, size_t needed) {
+    if (needed <= s->capacity) {
+        return 0;
+    }
+    size_t newCapacity = s->capacity * 2;
+    if (newCapacity < needed) {
+        newCapacity = needed;
+    }
+    char *block = (char *)malloc(newCapacity + 1);
+    if (block == NULL) {
+        return -1;
+    }
+    memcpy(block, lstrData(s), s->length + 1);
+    free(s->heap);
+    s->heap = block;
+    s->capacity = newCapacity;
+    return 0;
+}
+
+// Function to append 'n' bytes to the end of the string ('src' may point into 's' itself)
+int lstrAppend(LString *s, const char *src, size_t n) {
+    // Growing frees the old block, so remember where inside 's' the bytes were
+    uintptr_t start = (uintptr_t)lstrData(s);
+    int inside = (uintptr_t)src >= start && (uintptr_t)src < start + s->length;
+    size_t offset = (uintptr_t)src - start;
+    if (lstrReserve(s, s->length + n) != 0) {
+        return -1;
+    }
+    char *data = lstrData(s);
+    if (inside) {
+        src = data + offset;
+    }
+    memcpy(data + s->length, src, n);
+    s->length += n;
+    data[s->length] = '\0';
+    return 0;
+}
+
+// Function to append a C string
+int lstrAppendCString(LString *s, const char *src) {
+    return lstrAppend(s, src, strlen(src));
+}
+
+// Function to initialize a string from a C string
+int lstrFrom(LString *s, const char *src) {
+    lstrInit(s);
+    return lstrAppendCString(s, src);
+}
+
+// Function to compare two strings (same sign convention as strcmp)
+int lstrCompare(LString *a, LString *b) {
+    size_t shorter = a->length < b->length ? a->length : b->length;
+    int cmp = memcmp(lstrData(a), lstrData(b), shorter);
+    if (cmp != 0) {
+        return cmp;
+    }
+    if (a->length == b->length) {
+        return 0;
+    }
+    return a->length < b->length ? -1 : 1;
+}
+
+// Function to release heap memory (the string becomes empty again)
+void lstrFree(LString *s) {
+    free(s->heap);
+    lstrInit(s);
+}
+
+// The original approach from c_string_examples.c
+void concatStrings(char dest[], char src[]) {
+    strcat(dest, src);
+}
+
+// Function to read a monotonic clock in seconds
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to compare strcat-building against LString-building
+void benchmarkBuild(int pieces) {
+    char piece[] = "0123456789";
+    size_t pieceLength = strlen(piece);
+
+    char *flat = (char *)malloc(pieces * pieceLength + 1);
+    if (flat == NULL) {
+        printf("Out of memory.\n");
+        return;
+    }
+    flat[0] = '\0';
+    double start = nowSeconds();
+    for (int i = 0; i < pieces; i++) {
+        concatStrings(flat, piece);
+    }
+    double strcatTime = nowSeconds() - start;
+
+    LString built;
+    lstrInit(&built);
+    start = nowSeconds();
+    for (int i = 0; i < pieces; i++) {
+        lstrAppend(&built, piece, pieceLength);
+    }
+    double lstrTime = nowSeconds() - start;
+
+    printf("Building %d pieces (%zu bytes):\n", pieces, built.length);
+    printf("  concatStrings (strcat): %.4f s\n", strcatTime);
+    printf("  lstrAppend:             %.4f s\n", lstrTime);
+    printf("  Results match: %s\n", strcmp(flat, lstrData(&built)) == 0 ? "yes" : "no");
+
+    lstrFree(&built);
+    free(flat);
+}
+
+int main(int argc, char *argv[]) {
+    LString str1, str2;
+    lstrFrom(&str1, "Hello");
+    lstrFrom(&str2, "World");
+
+    printf("str1: %s (length %zu, inline: %s)\n", lstrData(&str1), str1.length,
+           str1.heap == NULL ? "yes" : "no");
+
+    // Concatenation never overflows: the string grows when needed
+    lstrAppend(&str1, lstrData(&str2), str2.length);
+    lstrAppendCString(&str1, ", this sentence no longer fits inline");
+    printf("str1: %s (length %zu, inline: %s)\n", lstrData(&str1), str1.length,
+           str1.heap == NULL ? "yes" : "no");
+
+    // Appending a string to itself works even when that moves it to a new block
+    size_t half = str1.length;
+    lstrAppend(&str1, lstrData(&str1), str1.length);
+    printf("str1 doubled: length %zu, halves match: %s\n", str1.length,
+           memcmp(lstrData(&str1), lstrData(&str1) + half, half) == 0 ? "yes" : "no");
+
+    int cmp = lstrCompare(&str1, &str2);
+    if (cmp == 0) {
+        printf("str1 and str2 are equal.\n");
+    } else if (cmp < 0) {
+        printf("str1 is less than str2.\n");
+    } else {
+        printf("str1 is greater than str2.\n");
+    }
+
+    lstrFree(&str1);
+    lstrFree(&str2);
+
+    // Benchmark: number of pieces can be given on the command line
+    int pieces = argc > 1 ? atoi(argv[1]) : 50000;
+    benchmarkBuild(pieces);
+
+    return 0;
+}
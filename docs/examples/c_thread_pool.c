@@ -0,0 +1,617 @@
+#define _GNU_SOURCE      // For CPU_SET and pthread_setaffinity_np()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+    WORK-STEALING THREAD POOL
+
+    Tasks:
+    - A Task is a small struct with a function pointer. Bigger structs put
+      a Task first (ForTask, Future), so a Task * can be cast back to them.
+
+    Work-stealing deques (Chase-Lev):
+    - Every worker has its own deque of tasks. The owner pushes and pops
+      at the bottom (newest first, which is cache friendly), without locks.
+    - Idle workers steal from the top of other workers' deques (oldest
+      first, which are usually the biggest pieces of work). Owner and
+      thieves only meet on the last task, where a compare-and-swap decides.
+    - Threads outside the pool submit through a small mutex-protected
+      injection queue.
+
+    Sleeping:
+    - A worker that finds no work registers as a sleeper, checks all
+      queues once more, and then waits on a condition variable. Submitters
+      only touch the lock when someone sleeps, so busy pools never lock.
+
+    Waiting without blocking:
+    - A thread that waits for a parallel_for or a future keeps running
+      other tasks until the thing it waits for is done. That keeps all
+      cores busy and makes nested parallelism safe.
+
+    parallelFor / parallelReduce:
+    - The range [begin, end) is split in halves: one half is pushed for
+      others to steal, the other half is split further, until pieces are
+      at most 'grain' iterations. grain = 0 picks about 8 pieces per worker.
+
+    Placement:
+    - PLACE_NONE lets the OS move threads freely. PLACE_COMPACT pins
+      worker i to the i-th allowed CPU, filling one NUMA node before the
+      next; PLACE_SCATTER alternates between nodes. Pinned workers try
+      to steal from workers on their own node first.
+    - NUMA nodes are read from /sys/devices/system/node; without it,
+      every CPU counts as node 0.
+*/
+
+#define MAX_WORKERS 64
+#define DEQUE_SIZE 4096          // Tasks per worker deque (power of two)
+#define MAX_CPUS 1024
+
+typedef struct Task {
+    void (*run)(struct Task *task);
+    struct Task *next;           // Injection queue link
+} Task;
+
+typedef struct {
+    _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic(Task *) slots[DEQUE_SIZE];
+} Deque;
+
+typedef enum { PLACE_NONE, PLACE_COMPACT, PLACE_SCATTER } Placement;
+
+struct Pool;
+
+typedef struct {
+    _Alignas(64) Deque deque;
+    struct Pool *pool;
+    int id;
+    int cpu;                     // -1 if not pinned
+    int node;
+    int victims[MAX_WORKERS];    // Steal order: same node first
+    pthread_t thread;
+} Worker;
+
+typedef struct Pool {
+    Worker *workers;
+    int workerCount;
+    pthread_mutex_t lock;        // Protects the injection queue and sleeping
+    pthread_cond_t wake;
+    Task *injectHead;
+    Task *injectTail;
+    _Atomic int injected;        // Number of tasks in the injection queue
+    _Atomic int sleepers;
+    uint64_t epoch;              // Bumped (under lock) whenever sleepers are woken
+    _Atomic int stop;
+} Pool;
+
+_Thread_local Worker *currentWorker;
+
+/* ---------- Chase-Lev deque ---------- */
+
+// Owner only: returns 0 if the deque is full
+int dequePush(Deque *d, Task *task) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= DEQUE_SIZE) return 0;
+    atomic_store_explicit(&d->slots[b & (DEQUE_SIZE - 1)], task, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);    // Publishes the task to thieves
+    return 1;
+}
+
+// Owner only: takes the newest task
+Task *dequePop(Deque *d) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    Task *task = NULL;
+    if (t <= b) {
+        task = atomic_load_explicit(&d->slots[b & (DEQUE_SIZE - 1)], memory_order_relaxed);
+        if (t == b) {
+            // Last task: race against thieves for it
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                task = NULL;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+// Any thread: takes the oldest task, or NULL if empty or another thief won
+Task *dequeSteal(Deque *d) {
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+    Task *task = atomic_load_explicit(&d->slots[t & (DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+    return task;
+}
+
+/* ---------- Scheduling ---------- */
+
+Task *takeInjected(Pool *pool) {
+    if (atomic_load_explicit(&pool->injected, memory_order_relaxed) == 0) return NULL;
+    pthread_mutex_lock(&pool->lock);
+    Task *task = pool->injectHead;
+    if (task != NULL) {
+        pool->injectHead = task->next;
+        if (pool->injectHead == NULL) pool->injectTail = NULL;
+        atomic_fetch_sub(&pool->injected, 1);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return task;
+}
+
+// Function to find a task for the calling thread (a worker or an outside thread)
+Task *findTask(Pool *pool) {
+    Worker *self = currentWorker != NULL && currentWorker->pool == pool ? currentWorker : NULL;
+    Task *task;
+    if (self != NULL && (task = dequePop(&self->deque)) != NULL) return task;
+    if ((task = takeInjected(pool)) != NULL) return task;
+    for (int i = 0; i < pool->workerCount; i++) {
+        int victim = self != NULL ? self->victims[i] : i;
+        if (self != NULL && victim == self->id) continue;
+        if ((task = dequeSteal(&pool->workers[victim].deque)) != NULL) return task;
+    }
+    return NULL;
+}
+
+// Function to make a task runnable
+void spawn(Pool *pool, Task *task) {
+    Worker *self = currentWorker;
+    if (self == NULL || self->pool != pool || !dequePush(&self->deque, task)) {
+        pthread_mutex_lock(&pool->lock);
+        task->next = NULL;
+        if (pool->injectTail != NULL) pool->injectTail->next = task;
+        else pool->injectHead = task;
+        pool->injectTail = task;
+        atomic_fetch_add(&pool->injected, 1);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    // Pairs with the sleeper's re-check in workerMain: either it sees the task or we see it
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pool->epoch++;
+        pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Function to run other tasks until *pending drops to 0
+void helpUntilDone(Pool *pool, _Atomic size_t *pending) {
+    while (atomic_load_explicit(pending, memory_order_acquire) != 0) {
+        Task *task = findTask(pool);
+        if (task != NULL) task->run(task);
+        else sched_yield();
+    }
+}
+
+void *workerMain(void *arg) {
+    Worker *self = arg;
+    Pool *pool = self->pool;
+    currentWorker = self;
+    if (self->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(self->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    int idle = 0;
+    while (!atomic_load(&pool->stop)) {
+        Task *task = findTask(pool);
+        if (task != NULL) {
+            task->run(task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < 64) {
+            sched_yield();
+            continue;
+        }
+        // Register as a sleeper, then look once more before really sleeping
+        pthread_mutex_lock(&pool->lock);
+        uint64_t epoch = pool->epoch;
+        atomic_fetch_add(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->lock);
+        task = findTask(pool);
+        pthread_mutex_lock(&pool->lock);
+        while (task == NULL && pool->epoch == epoch && !atomic_load(&pool->stop)) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->lock);
+        if (task != NULL) task->run(task);
+        idle = 0;
+    }
+    return NULL;
+}
+
+/* ---------- CPU and NUMA placement ---------- */
+
+// Function to read the NUMA node of every CPU from sysfs (node 0 if unknown)
+void readCpuNodes(int *nodeOf) {
+    for (int c = 0; c < MAX_CPUS; c++) nodeOf[c] = 0;
+    for (int node = 0; node < 64; node++) {
+        char path[64], list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (f == NULL) continue;
+        if (fgets(list, sizeof(list), f) != NULL) {
+            // Format: "0-3,8-11"
+            char *p = list;
+            while (*p >= '0' && *p <= '9') {
+                int first = (int)strtol(p, &p, 10), last = first;
+                if (*p == '-') last = (int)strtol(p + 1, &p, 10);
+                for (int c = first; c <= last && c < MAX_CPUS; c++) nodeOf[c] = node;
+                if (*p == ',') p++;
+            }
+        }
+        fclose(f);
+    }
+}
+
+// Function to choose a CPU and node for every worker, and each worker's steal order
+void placeWorkers(Pool *pool, Placement placement) {
+    static int nodeOf[MAX_CPUS];
+    int cpus[MAX_CPUS], count = 0;
+    cpu_set_t allowed;
+    readCpuNodes(nodeOf);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < MAX_CPUS && c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpus[count++] = c;
+        }
+    }
+    // Order CPUs by (node, cpu) for compact placement
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && nodeOf[cpus[j - 1]] > nodeOf[cpus[j]]; j--) {
+            int t = cpus[j]; cpus[j] = cpus[j - 1]; cpus[j - 1] = t;
+        }
+    }
+    if (placement == PLACE_SCATTER && count > 0) {
+        // Take one CPU from each node in turn
+        int order[MAX_CPUS], used[MAX_CPUS] = {0}, n = 0;
+        while (n < count) {
+            int lastNode = -1;
+            for (int i = 0; i < count; i++) {
+                if (!used[i] && nodeOf[cpus[i]] != lastNode) {
+                    order[n++] = cpus[i];
+                    used[i] = 1;
+                    lastNode = nodeOf[cpus[i]];
+                }
+            }
+        }
+        memcpy(cpus, order, count * sizeof(int));
+    }
+    for (int i = 0; i < pool->workerCount; i++) {
+        Worker *w = &pool->workers[i];
+        w->cpu = placement != PLACE_NONE && count > 0 ? cpus[i % count] : -1;
+        w->node = w->cpu >= 0 ? nodeOf[w->cpu] : 0;
+    }
+    // Steal order: workers on the same node first, then the rest, starting after yourself
+    for (int i = 0; i < pool->workerCount; i++) {
+        Worker *w = &pool->workers[i];
+        int n = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            for (int k = 1; k <= pool->workerCount; k++) {
+                int v = (i + k) % pool->workerCount;
+                if ((pool->workers[v].node == w->node) == (pass == 0)) w->victims[n++] = v;
+            }
+        }
+    }
+}
+
+/* ---------- Pool lifetime ---------- */
+
+// Function to start a pool; returns NULL on failure
+Pool *poolCreate(int workers, Placement placement) {
+    if (workers < 1) workers = 1;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    Pool *pool = calloc(1, sizeof(Pool));
+    if (pool == NULL) return NULL;
+    pool->workers = aligned_alloc(64, sizeof(Worker) * workers);
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    memset(pool->workers, 0, sizeof(Worker) * workers);
+    pool->workerCount = workers;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    for (int i = 0; i < workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+    }
+    placeWorkers(pool, placement);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, workerMain, &pool->workers[i]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    return pool;
+}
+
+void poolDestroy(Pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stop, 1);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->workerCount; i++) pthread_join(pool->workers[i].thread, NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->workers);
+    free(pool);
+}
+
+/* ---------- parallelFor and parallelReduce ---------- */
+
+typedef void (*RangeBody)(void *context, size_t lo, size_t hi);
+
+typedef struct ForJob ForJob;
+
+typedef struct {
+    Task task;                   // Must be first
+    ForJob *job;
+    size_t lo;
+    size_t hi;
+} ForTask;
+
+struct ForJob {
+    Pool *pool;
+    RangeBody body;
+    void *context;
+    size_t grain;
+    _Atomic size_t pending;      // Ranges not finished yet
+    ForTask *nodes;              // Preallocated tasks for the split halves
+    _Atomic size_t nextNode;
+};
+
+void runForTask(Task *task) {
+    ForTask *t = (ForTask *)task;
+    ForJob *job = t->job;
+    size_t lo = t->lo, hi = t->hi;
+    while (hi - lo > job->grain) {
+        size_t mid = lo + (hi - lo) / 2;
+        ForTask *half = &job->nodes[atomic_fetch_add_explicit(&job->nextNode, 1, memory_order_relaxed)];
+        *half = (ForTask){{runForTask, NULL}, job, mid, hi};
+        atomic_fetch_add_explicit(&job->pending, 1, memory_order_relaxed);
+        spawn(job->pool, &half->task);
+        hi = mid;
+    }
+    job->body(job->context, lo, hi);
+    atomic_fetch_sub_explicit(&job->pending, 1, memory_order_release);
+}
+
+// Function to call body(context, lo, hi) over [begin, end) in parallel; returns 0 on success
+int parallelFor(Pool *pool, size_t begin, size_t end, size_t grain, RangeBody body, void *context) {
+    if (end <= begin) return 0;
+    size_t n = end - begin;
+    if (grain == 0) grain = n / (8 * (size_t)pool->workerCount) + 1;
+    // Halving creates fewer than 2 * n / grain + 2 pieces
+    ForJob job = {pool, body, context, grain, 1, malloc((2 * (n / grain) + 2) * sizeof(ForTask)), 0};
+    if (job.nodes == NULL) return -1;
+    ForTask root = {{runForTask, NULL}, &job, begin, end};
+    runForTask(&root.task);      // The caller splits and works on the first piece itself
+    helpUntilDone(pool, &job.pending);
+    free(job.nodes);
+    return 0;
+}
+
+typedef double (*RangeReduce)(void *context, size_t lo, size_t hi);
+
+typedef struct {
+    _Alignas(64) double value;
+} PaddedDouble;
+
+typedef struct {
+    RangeReduce chunk;
+    double (*combine)(double, double);
+    void *context;
+    PaddedDouble partial[MAX_WORKERS];
+    double outside;              // Partial result of threads outside the pool
+    double identity;
+    pthread_mutex_t outsideLock;
+} ReduceJob;
+
+void reduceBody(void *context, size_t lo, size_t hi) {
+    ReduceJob *r = context;
+    double value = r->chunk(r->context, lo, hi);
+    Worker *self = currentWorker;
+    if (self != NULL) {
+        // Each worker only ever touches its own slot
+        r->partial[self->id].value = r->combine(r->partial[self->id].value, value);
+    } else {
+        pthread_mutex_lock(&r->outsideLock);
+        r->outside = r->combine(r->outside, value);
+        pthread_mutex_unlock(&r->outsideLock);
+    }
+}
+
+// Function to combine chunk(context, lo, hi) over [begin, end); combine must be associative and commutative
+double parallelReduce(Pool *pool, size_t begin, size_t end, size_t grain, double identity, RangeReduce chunk,
+                      double (*combine)(double, double), void *context) {
+    ReduceJob r = {.chunk = chunk, .combine = combine, .context = context, .outside = identity,
+                   .identity = identity};
+    pthread_mutex_init(&r.outsideLock, NULL);
+    for (int i = 0; i < pool->workerCount; i++) r.partial[i].value = identity;
+    // Nested reduces on a worker would share its slot, so they run as plain loops
+    if (currentWorker != NULL || parallelFor(pool, begin, end, grain, reduceBody, &r) != 0) {
+        r.outside = chunk(context, begin, end);
+    }
+    double result = r.outside;
+    for (int i = 0; i < pool->workerCount; i++) result = combine(result, r.partial[i].value);
+    pthread_mutex_destroy(&r.outsideLock);
+    return result;
+}
+
+/* ---------- Futures ---------- */
+
+typedef struct {
+    Task task;                   // Must be first
+    Pool *pool;
+    void *(*function)(void *);
+    void *argument;
+    void *result;
+    _Atomic size_t pending;      // 1 until the function has returned
+} Future;
+
+void runFuture(Task *task) {
+    Future *f = (Future *)task;
+    f->result = f->function(f->argument);
+    atomic_store_explicit(&f->pending, 0, memory_order_release);
+}
+
+// Function to run function(argument) asynchronously; returns NULL if out of memory
+Future *poolAsync(Pool *pool, void *(*function)(void *), void *argument) {
+    Future *f = malloc(sizeof(Future));
+    if (f == NULL) return NULL;
+    *f = (Future){{runFuture, NULL}, pool, function, argument, NULL, 1};
+    spawn(pool, &f->task);
+    return f;
+}
+
+// Function to wait for a future (running other tasks meanwhile), free it and return its result
+void *futureGet(Future *f) {
+    helpUntilDone(f->pool, &f->pending);
+    void *result = f->result;
+    free(f);
+    return result;
+}
+
+/* ---------- Example kernels and benchmarks ---------- */
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// sumArray from the arrays example, as a chunk of a reduction
+double sumChunk(void *context, size_t lo, size_t hi) {
+    const int *arr = context;
+    long long sum = 0;
+    for (size_t i = lo; i < hi; i++) sum += arr[i];
+    return (double)sum;
+}
+
+double add(double a, double b) {
+    return a + b;
+}
+
+// A compute-heavy kernel: out[i] = a short series per element
+void computeChunk(void *context, size_t lo, size_t hi) {
+    double *out = context;
+    for (size_t i = lo; i < hi; i++) {
+        double x = (double)i * 1e-6, y = 0;
+        for (int k = 1; k <= 32; k++) y += sin(x * k) / k;
+        out[i] = y;
+    }
+}
+
+void emptyChunk(void *context, size_t lo, size_t hi) {
+    (void)context; (void)lo; (void)hi;
+}
+
+Pool *fibPool;
+
+// Naive Fibonacci with a future for every call above the cutoff
+void *fibTask(void *arg) {
+    intptr_t n = (intptr_t)arg;
+    if (n < 2) return (void *)n;
+    Future *left = poolAsync(fibPool, fibTask, (void *)(n - 1));
+    intptr_t right = (intptr_t)fibTask((void *)(n - 2));
+    return (void *)((intptr_t)futureGet(left) + right);
+}
+
+long countFutures(int n) {
+    return n < 2 ? 0 : 1 + countFutures(n - 1) + countFutures(n - 2);
+}
+
+int main(int argc, char *argv[]) {
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int maxWorkers = argc > 1 ? atoi(argv[1]) : cpus;
+    Placement placement = argc > 2 && strcmp(argv[2], "compact") == 0   ? PLACE_COMPACT
+                          : argc > 2 && strcmp(argv[2], "scatter") == 0 ? PLACE_SCATTER
+                                                                         : PLACE_NONE;
+    if (maxWorkers < 1 || maxWorkers > MAX_WORKERS) maxWorkers = cpus < MAX_WORKERS ? cpus : MAX_WORKERS;
+
+    size_t n = 20000000;
+    int *numbers = malloc(n * sizeof(int));
+    double *out = malloc(n / 16 * sizeof(double));
+    if (numbers == NULL || out == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) numbers[i] = (int)(i % 1000);
+    double expected = sumChunk(numbers, 0, n);
+
+    // Placement of the largest pool
+    Pool *pool = poolCreate(maxWorkers, placement);
+    if (pool == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    printf("Workers: %d, placement: %s\n", maxWorkers,
+           placement == PLACE_COMPACT ? "compact" : placement == PLACE_SCATTER ? "scatter" : "none");
+    if (placement != PLACE_NONE) {
+        for (int i = 0; i < pool->workerCount; i++) {
+            printf("  worker %d -> cpu %d (node %d)\n", i, pool->workers[i].cpu, pool->workers[i].node);
+        }
+    }
+
+    // Scheduling overhead: pieces of one iteration each, and one future per Fibonacci call
+    size_t tasks = 1000000;
+    double start = nowSeconds();
+    parallelFor(pool, 0, tasks, 1, emptyChunk, NULL);
+    double forTime = nowSeconds() - start;
+    fibPool = pool;
+    start = nowSeconds();
+    intptr_t fib = (intptr_t)futureGet(poolAsync(pool, fibTask, (void *)25));
+    double fibTime = nowSeconds() - start;
+    long futures = countFutures(25);
+    printf("\nOverhead per task:\n");
+    printf("  parallelFor, grain 1:   %.1f ns (%zu pieces)\n", forTime * 1e9 / tasks, tasks);
+    printf("  futures, fib(25) = %ld: %.1f ns (%ld futures)\n", (long)fib, fibTime * 1e9 / futures, futures);
+    poolDestroy(pool);
+
+    // Scalability of the example kernels
+    printf("\n%8s | %22s | %22s\n", "workers", "sumArray (reduce)", "series (parallelFor)");
+    double baseSum = 0, baseCompute = 0;
+    for (int workers = 1; workers <= maxWorkers; workers *= 2) {
+        pool = poolCreate(workers, placement);
+        start = nowSeconds();
+        double sum = parallelReduce(pool, 0, n, 0, 0.0, sumChunk, add, numbers);
+        double sumTime = nowSeconds() - start;
+        start = nowSeconds();
+        parallelFor(pool, 0, n / 16, 0, computeChunk, out);
+        double computeTime = nowSeconds() - start;
+        poolDestroy(pool);
+        if (workers == 1) {
+            baseSum = sumTime;
+            baseCompute = computeTime;
+        }
+        printf("%8d | %8.2f ms  x%4.1f %s | %8.2f ms  x%4.1f\n", workers, sumTime * 1e3, baseSum / sumTime,
+               sum == expected ? "ok" : "!!", computeTime * 1e3, baseCompute / computeTime);
+    }
+
+    free(numbers);
+    free(out);
+    return 0;
+}
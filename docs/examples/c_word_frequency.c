@@ -0,0 +1,427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/*
+    WORD FREQUENCY ENGINE
+
+    Words:
+    - The same rule as the word counter in c_text_processing_examples.c:
+      ' ', '\n' and '\t' separate words; every other byte belongs to one.
+      Words are case-sensitive byte strings ("The" and "the" differ).
+
+    Counting:
+    - Each thread counts its own slice of the (memory-mapped) file into its
+      own hash table, so threads never share memory while counting.
+    - The table uses open addressing: all entries live in one array, and a
+      collision moves on to the next slot (linear probing). Entries store
+      the full 64-bit hash, so most mismatches are rejected without
+      comparing bytes.
+    - Word bytes are copied once, when a word is seen for the first time,
+      into an arena: big blocks that are filled from the front and freed
+      all together. There is no malloc() per word.
+
+    Memory:
+    - Memory grows with the number of distinct words, never with the
+      number of tokens: a billion tokens of a 100,000-word vocabulary use
+      the same memory as a million.
+
+    Results:
+    - The per-thread tables are merged into the first one (entries keep
+      pointing into their thread's arena, so nothing is copied again).
+    - The top K words are selected with a min-heap of size K: a word
+      enters the heap only if it beats the smallest count in it.
+
+    Usage:
+        word_frequency [-k K] [-j threads] FILE
+        word_frequency -g TOKENS > FILE     (write a random test text)
+*/
+
+#define MAX_THREADS 64
+#define ARENA_BLOCK (1 << 20)
+#define VOCABULARY 100000       // Distinct words in the generated test text
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+    size_t bytes;              // Total allocated, for the memory report
+} Arena;
+
+typedef struct {
+    uint64_t hash;
+    const char *word;          // NULL marks an empty slot
+    uint32_t length;
+    uint64_t count;
+} Entry;
+
+typedef struct {
+    Entry *entries;
+    size_t capacity;           // Power of two
+    size_t size;
+    Arena arena;
+} WordTable;
+
+/* ---------- Arena ---------- */
+
+// Function to copy n bytes into the arena; returns NULL if out of memory
+char *arenaCopy(Arena *a, const char *bytes, size_t n) {
+    if (a->head == NULL || a->head->used + n > ARENA_BLOCK) {
+        size_t size = n > ARENA_BLOCK ? n : ARENA_BLOCK;
+        ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+        if (block == NULL) return NULL;
+        block->next = a->head;
+        block->used = 0;
+        a->head = block;
+        a->bytes += sizeof(ArenaBlock) + size;
+    }
+    char *p = a->head->data + a->head->used;
+    memcpy(p, bytes, n);
+    a->head->used += n;
+    return p;
+}
+
+void arenaFree(Arena *a) {
+    while (a->head != NULL) {
+        ArenaBlock *next = a->head->next;
+        free(a->head);
+        a->head = next;
+    }
+    a->bytes = 0;
+}
+
+/* ---------- Hash table ---------- */
+
+// Function to hash a word, 8 bytes at a time
+static inline uint64_t hashWord(const char *p, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        h = (h ^ v) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 29;
+        p += 8;
+        n -= 8;
+    }
+    if (n > 0) {
+        uint64_t v = 0;
+        memcpy(&v, p, n);
+        h = (h ^ v) * 0xbf58476d1ce4e5b9ULL;
+    }
+    h ^= h >> 32;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 29);
+}
+
+int tableInit(WordTable *t, size_t capacity) {
+    memset(t, 0, sizeof(*t));
+    t->entries = calloc(capacity, sizeof(Entry));
+    t->capacity = capacity;
+    return t->entries == NULL ? -1 : 0;
+}
+
+// Function to double the table; returns 0 on success
+int tableGrow(WordTable *t) {
+    size_t capacity = t->capacity * 2;
+    Entry *entries = calloc(capacity, sizeof(Entry));
+    if (entries == NULL) return -1;
+    for (size_t i = 0; i < t->capacity; i++) {
+        Entry *e = &t->entries[i];
+        if (e->word == NULL) continue;
+        size_t j = e->hash & (capacity - 1);
+        while (entries[j].word != NULL) j = (j + 1) & (capacity - 1);
+        entries[j] = *e;
+    }
+    free(t->entries);
+    t->entries = entries;
+    t->capacity = capacity;
+    return 0;
+}
+
+// Function to add 'count' to a word; copyWord = 0 reuses the caller's bytes (they must stay alive)
+// Returns 0 on success, -1 if out of memory
+int tableAdd(WordTable *t, const char *word, size_t length, uint64_t hash, uint64_t count, int copyWord) {
+    size_t mask = t->capacity - 1;
+    size_t i = hash & mask;
+    for (;;) {
+        Entry *e = &t->entries[i];
+        if (e->word == NULL) break;
+        if (e->hash == hash && e->length == length && memcmp(e->word, word, length) == 0) {
+            e->count += count;
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+    // New word: keep the load factor below 70%
+    if ((t->size + 1) * 10 > t->capacity * 7) {
+        if (tableGrow(t) != 0) return -1;
+        return tableAdd(t, word, length, hash, count, copyWord);
+    }
+    const char *stored = copyWord ? arenaCopy(&t->arena, word, length) : word;
+    if (stored == NULL) return -1;
+    t->entries[i] = (Entry){hash, stored, (uint32_t)length, count};
+    t->size++;
+    return 0;
+}
+
+void tableFree(WordTable *t) {
+    free(t->entries);
+    arenaFree(&t->arena);
+}
+
+/* ---------- Counting ---------- */
+
+static const unsigned char separators[256] = {[' '] = 1, ['\n'] = 1, ['\t'] = 1};
+
+typedef struct {
+    const char *begin;
+    const char *end;
+    WordTable table;
+    uint64_t tokens;
+    int failed;
+} CountJob;
+
+void *countSlice(void *arg) {
+    CountJob *job = arg;
+    const char *p = job->begin, *end = job->end;
+    uint64_t tokens = 0;
+    while (p < end) {
+        while (p < end && separators[(unsigned char)*p]) p++;
+        const char *start = p;
+        while (p < end && !separators[(unsigned char)*p]) p++;
+        if (p > start) {
+            size_t length = p - start;
+            if (length > UINT32_MAX || tableAdd(&job->table, start, length, hashWord(start, length), 1, 1) != 0) {
+                job->failed = 1;
+                return NULL;
+            }
+            tokens++;
+        }
+    }
+    job->tokens = tokens;
+    return NULL;
+}
+
+/* ---------- Top K with a min-heap ---------- */
+
+// Function to order entries: lower count first, then later in the alphabet first
+int entryLess(const Entry *a, const Entry *b) {
+    if (a->count != b->count) return a->count < b->count;
+    size_t n = a->length < b->length ? a->length : b->length;
+    int c = memcmp(a->word, b->word, n);
+    return c != 0 ? c > 0 : a->length > b->length;
+}
+
+void siftDown(Entry **heap, size_t n, size_t i) {
+    for (;;) {
+        size_t smallest = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < n && entryLess(heap[l], heap[smallest])) smallest = l;
+        if (r < n && entryLess(heap[r], heap[smallest])) smallest = r;
+        if (smallest == i) return;
+        Entry *tmp = heap[i]; heap[i] = heap[smallest]; heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+// Function to find the k largest entries; fills heap and returns how many, largest first
+size_t topK(const WordTable *t, Entry **heap, size_t k) {
+    size_t n = 0;
+    for (size_t i = 0; i < t->capacity; i++) {
+        Entry *e = &t->entries[i];
+        if (e->word == NULL) continue;
+        if (n < k) {
+            // Grow the heap and move the new entry up to its place
+            size_t j = n++;
+            heap[j] = e;
+            while (j > 0 && entryLess(heap[j], heap[(j - 1) / 2])) {
+                Entry *tmp = heap[j]; heap[j] = heap[(j - 1) / 2]; heap[(j - 1) / 2] = tmp;
+                j = (j - 1) / 2;
+            }
+        } else if (k > 0 && entryLess(heap[0], e)) {
+            heap[0] = e;             // Replace the smallest of the top K
+            siftDown(heap, n, 0);
+        }
+    }
+    // Heap sort: repeatedly move the smallest to the end, leaving the largest first
+    for (size_t m = n; m > 1; m--) {
+        Entry *tmp = heap[0]; heap[0] = heap[m - 1]; heap[m - 1] = tmp;
+        siftDown(heap, m - 1, 0);
+    }
+    return n;
+}
+
+/* ---------- Test data and main ---------- */
+
+// Function to write 'tokens' words with Zipf frequencies: the word of rank r has weight 1/r
+int generateText(uint64_t tokens) {
+    static const char *syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "te", "vo", "zu", "pi", "da", "go"};
+    // cumulative[r] = 1/1 + 1/2 + ... + 1/(r + 1): the running total of the weights
+    double *cumulative = malloc(VOCABULARY * sizeof(double));
+    if (cumulative == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    double sum = 0;
+    for (size_t r = 0; r < VOCABULARY; r++) {
+        sum += 1.0 / (r + 1);
+        cumulative[r] = sum;
+    }
+    uint64_t state = 88172645463325252ULL;
+    char line[256];
+    size_t length = 0;
+    for (uint64_t i = 0; i < tokens; i++) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        // Binary search for the first rank whose running total exceeds a uniform point in [0, sum)
+        double point = (double)(state >> 11) / (1ULL << 53) * sum;
+        size_t low = 0, high = VOCABULARY - 1;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (cumulative[middle] > point) high = middle;
+            else low = middle + 1;
+        }
+        uint64_t rank = low;
+        char word[32];
+        int n = 0;
+        do {
+            memcpy(word + n, syllables[rank % 12], 2);
+            n += 2;
+            rank /= 12;
+        } while (rank > 0);
+        if (length + n + 1 >= sizeof(line)) {
+            line[length++] = '\n';
+            fwrite(line, 1, length, stdout);
+            length = 0;
+        }
+        memcpy(line + length, word, n);
+        length += n;
+        line[length++] = i % 17 == 16 ? '\t' : ' ';
+    }
+    line[length++] = '\n';
+    fwrite(line, 1, length, stdout);
+    free(cumulative);
+    return 0;
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    size_t k = 10;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "k:j:g:")) != -1) {
+        if (opt == 'k') {
+            k = (size_t)atol(optarg);
+        } else if (opt == 'j') {
+            threads = atoi(optarg);
+        } else if (opt == 'g') {
+            return generateText(strtoull(optarg, NULL, 10));
+        } else {
+            fprintf(stderr, "Usage: %s [-k K] [-j threads] FILE | %s -g TOKENS\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: %s [-k K] [-j threads] FILE | %s -g TOKENS\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (size > 0) madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    // Slices end at a separator, so no word is split between two threads
+    double start = nowSeconds();
+    CountJob jobs[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    const char *p = data, *end = data + size;
+    int used = 0;
+    for (int i = 0; i < threads && p < end; i++) {
+        const char *sliceEnd = i == threads - 1 ? end : p + (end - p) / (threads - i);
+        while (sliceEnd < end && !separators[(unsigned char)*sliceEnd]) sliceEnd++;
+        jobs[i] = (CountJob){p, sliceEnd, {0}, 0, 0};
+        if (tableInit(&jobs[i].table, 1 << 14) != 0) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        p = sliceEnd;
+        used++;
+    }
+    for (int i = 1; i < used; i++) pthread_create(&ids[i], NULL, countSlice, &jobs[i]);
+    if (used > 0) countSlice(&jobs[0]);
+    for (int i = 1; i < used; i++) pthread_join(ids[i], NULL);
+    double countTime = nowSeconds() - start;
+
+    // Merge every table into the first one
+    start = nowSeconds();
+    WordTable empty;
+    WordTable *total = used > 0 ? &jobs[0].table : &empty;
+    if (used == 0 && tableInit(&empty, 16) != 0) return 1;
+    uint64_t tokens = used > 0 ? jobs[0].tokens : 0;
+    size_t memory = 0;
+    for (int i = 0; i < used; i++) {
+        if (jobs[i].failed) {
+            printf("Out of memory while counting.\n");
+            return 1;
+        }
+        if (i == 0) continue;
+        tokens += jobs[i].tokens;
+        WordTable *t = &jobs[i].table;
+        for (size_t j = 0; j < t->capacity; j++) {
+            Entry *e = &t->entries[j];
+            if (e->word != NULL && tableAdd(total, e->word, e->length, e->hash, e->count, 0) != 0) {
+                printf("Out of memory while merging.\n");
+                return 1;
+            }
+        }
+    }
+    for (int i = 0; i < used; i++) memory += jobs[i].table.capacity * sizeof(Entry) + jobs[i].table.arena.bytes;
+
+    Entry **heap = malloc((k > 0 ? k : 1) * sizeof(Entry *));
+    if (heap == NULL) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    size_t shown = topK(total, heap, k);
+    double mergeTime = nowSeconds() - start;
+
+    for (size_t i = 0; i < shown; i++) {
+        printf("%12llu %.*s\n", (unsigned long long)heap[i]->count, (int)heap[i]->length, heap[i]->word);
+    }
+    fprintf(stderr, "%llu tokens, %zu distinct words, %d threads\n", (unsigned long long)tokens, total->size, used);
+    fprintf(stderr, "count: %.3f s (%.1f M tokens/s), merge + top %zu: %.3f s, tables + arenas: %.1f MB\n",
+            countTime, tokens / countTime / 1e6, k, mergeTime, memory / 1048576.0);
+
+    free(heap);
+    for (int i = 0; i < used; i++) tableFree(&jobs[i].table);
+    if (used == 0) tableFree(&empty);
+    if (size > 0) munmap((void *)data, size);
+    return 0;
+}